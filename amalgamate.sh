@@ -0,0 +1,54 @@
+#! /bin/bash
+#
+# single-header poly2tri.h from include/, the hot accessors static inline
+#
+#   ./amalgamate.sh [output]        default dist/poly2tri.h
+#
+# each header is pasted at its first #include "..." site and dropped at the later ones,
+# except geometry_kernels.h, which is meant to be pasted once per SIMD level
+#
+cd "$(dirname "$0")"
+OUT=${1:-dist/poly2tri.h}
+mkdir -p "$(dirname "$OUT")"
+
+paste_header() {
+  local file=$1
+  while IFS= read -r line || [ -n "$line" ]; do
+    if [[ $line =~ ^[[:space:]]*#[[:space:]]*include[[:space:]]+\"([^\"]+)\" ]]; then
+      local inc=${BASH_REMATCH[1]}
+      if [ "$inc" = geometry_kernels.h ] || [ -z "${PASTED[$inc]}" ]; then
+        PASTED[$inc]=1
+        echo "// ---- $inc ----"
+        paste_header "include/$inc"
+        echo "// ---- end of $inc ----"
+      fi
+      continue
+    fi
+    printf '%s\n' "$line"
+  done < "$file"
+}
+
+declare -A PASTED
+{
+  echo "// poly2tri.h, generated by amalgamate.sh from $(git describe --always --dirty 2>/dev/null || echo include/), do not edit"
+  echo "//"
+  echo "// #define POLY2TRI_IMPLEMENTATION in exactly one translation unit before including it."
+  echo "// Every translation unit gets its own static inline copy of the hot accessors,"
+  echo "// #define POLY2TRI_EXTERN_ACCESSORS to link against the implementation's instead."
+  echo "// They are always extern in an instantiation under POLY2TRI_PREFIX."
+  echo "#if !defined(POLY2TRI_EXTERN_ACCESSORS) && !defined(POLY2TRI_PREFIX)"
+  echo "#ifndef POLY2TRI_STATIC_INLINE"
+  echo "#define POLY2TRI_STATIC_INLINE"
+  echo "#endif"
+  echo "#endif"
+  echo
+  for h in polygon_triangulate.h polygon_earcut.h poly2tri_instance.h; do
+    PASTED[$h]=1
+    echo "// ---- $h ----"
+    paste_header "include/$h"
+    echo "// ---- end of $h ----"
+    echo
+  done
+} > "$OUT.tmp" && mv "$OUT.tmp" "$OUT"
+
+echo "$OUT"
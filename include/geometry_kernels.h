@@ -0,0 +1,136 @@
+/**
+ * The vector kernels of geometry_type.h, included by its implementation once per SIMD level
+ * with KERNEL(name) naming the level's variant, KERNEL_TARGET its target attribute and
+ * KERNEL_VEC_BYTES the width of a coord_t vector at that level; hence no include guard.
+ *
+ * Vectors are only ever locals, the kernels take and return scalars and pointers.
+ * The products are taken in area_t lanes, so integer coordinates can't overflow.
+ */
+
+#define KERNEL_LANES ((vidx_t)(KERNEL_VEC_BYTES / sizeof(coord_t)))
+typedef area_t KERNEL(areav_t) __attribute__((vector_size(KERNEL_LANES * sizeof(area_t))));
+typedef real_t KERNEL(realv_t) __attribute__((vector_size(KERNEL_LANES * sizeof(real_t))));
+
+// the signed_area() terms of the pairs (I - 1, I) from *AT on, as far as whole vectors reach END,
+// each lane compensated, the lanes summed pairwise; advances *AT past them
+static KERNEL_TARGET area_t KERNEL(ring_area)(const coord_t px[], const coord_t py[], vidx_t* at, vidx_t end)
+{
+    KERNEL(areav_t) vsum = {}, vcomp = {};
+    vidx_t i = *at;
+    for (; i + KERNEL_LANES <= end; i += KERNEL_LANES) {
+        KERNEL(areav_t) x_j, y_j, x_i, y_i;
+        AREAV_LOAD(x_j, px + i - 1);
+        AREAV_LOAD(y_j, py + i - 1);
+        AREAV_LOAD(x_i, px + i);
+        AREAV_LOAD(y_i, py + i);
+        KAHAN_ADD(vsum, vcomp, (x_j - x_i) * (y_i + y_j));
+    }
+    *at = i;
+    return VEC_REDUCE(vsum) - VEC_REDUCE(vcomp);
+}
+
+// as ring_area(), for vertices_validate(): stops in front of the first vector holding
+// a duplicate or a sharp vertex, and always before the vertex I + 1 wraps around END
+static KERNEL_TARGET area_t KERNEL(ring_validate)(const coord_t px[], const coord_t py[], vidx_t* at, vidx_t end)
+{
+    KERNEL(areav_t) vsum = {}, vcomp = {};
+    vidx_t i = *at;
+    for (; i + KERNEL_LANES < end; i += KERNEL_LANES) {
+        KERNEL(areav_t) x1, y1, x2, y2, x3, y3;
+        AREAV_LOAD(x1, px + i - 1);
+        AREAV_LOAD(y1, py + i - 1);
+        AREAV_LOAD(x2, px + i);
+        AREAV_LOAD(y2, py + i);
+        AREAV_LOAD(x3, px + i + 1);
+        AREAV_LOAD(y3, py + i + 1);
+
+        __auto_type dot   = ( x3 - x2 ) * ( x1 - x2 ) + ( y3 - y2 ) * ( y1 - y2 );
+        __auto_type cross = ( x3 - x2 ) * ( y1 - y2 ) - ( y3 - y2 ) * ( x1 - x2 );
+        __auto_type bad = ( ( x1 == x2 ) & ( y1 == y2 ) ) | ( ( x3 == x2 ) & ( y3 == y2 ) )
+            | ( ( dot == 0 ) & ( cross == 0 ) )
+            | ( ( dot > 0 ) & ( cross >= 0 ) & ( __builtin_convertvector(cross, KERNEL(realv_t))
+                                                 <= (real_t)ANGLE_TOL_TAN * __builtin_convertvector(dot, KERNEL(realv_t)) ) );
+        // the scalar loop of the caller locates the offending vertex
+        if (VEC_ANY(bad)) break;
+
+        KAHAN_ADD(vsum, vcomp, (x1 - x2) * (y2 + y1));
+    }
+    *at = i;
+    return VEC_REDUCE(vsum) - VEC_REDUCE(vcomp);
+}
+
+// intersects_any(), see there
+static KERNEL_TARGET bool KERNEL(intersects_any)(const coord_t ax, const coord_t ay, const coord_t bx, const coord_t by, vidx_t m,
+                                                 const coord_t xc[], const coord_t yc[], const coord_t xd[], const coord_t yd[])
+{
+    // A:B once, in area_t like the lanes
+    const area_t abx = (area_t)bx - ax;
+    const area_t aby = (area_t)by - ay;
+#ifndef USING_INT32_COORD
+    // twice r8_eps, so rounding can't flip a lane out of the scalar path
+    const area_t near_eps = (area_t)(2 * r8_eps);
+    // broadcast, so every comparison below yields a lane mask
+    const KERNEL(areav_t) side_ab_sq = (KERNEL(areav_t)){} + (abx * abx + aby * aby);
+#endif
+
+    vidx_t k = 0;
+    for (; k + KERNEL_LANES <= m; k += KERNEL_LANES) {
+        KERNEL(areav_t) cx, cy, dx, dy;
+        AREAV_LOAD(cx, xc + k);
+        AREAV_LOAD(cy, yc + k);
+        AREAV_LOAD(dx, xd + k);
+        AREAV_LOAD(dy, yd + k);
+
+        __auto_type t1 = abx * ( cy - ay ) - ( cx - ax ) * aby;
+        __auto_type t2 = abx * ( dy - ay ) - ( dx - ax ) * aby;
+        __auto_type t3 = ( dx - cx ) * ( ay - cy ) - ( ax - cx ) * ( dy - cy );
+        __auto_type t4 = ( dx - cx ) * ( by - cy ) - ( bx - cx ) * ( dy - cy );
+
+#ifdef USING_INT32_COORD
+        // the determinants are exact, only a collinear lane needs the scalar between() tests
+        __auto_type near = ( t1 == 0 ) | ( t2 == 0 ) | ( t3 == 0 ) | ( t4 == 0 );
+#else
+        __auto_type side_ac_sq = (ax - cx) * (ax - cx) + (ay - cy) * (ay - cy);
+        __auto_type side_ad_sq = (ax - dx) * (ax - dx) + (ay - dy) * (ay - dy);
+        __auto_type side_bc_sq = (bx - cx) * (bx - cx) + (by - cy) * (by - cy);
+        __auto_type side_bd_sq = (bx - dx) * (bx - dx) + (by - dy) * (by - dy);
+        __auto_type side_cd_sq = (cx - dx) * (cx - dx) + (cy - dy) * (cy - dy);
+
+        // |2 * T| <= eps * max(S1, S2, S3), without a lane-wise max or abs
+#define NEAR_COLLINEAR(t, s1, s2, s3) ( ( ( 2 * t <= near_eps * s1 ) | ( 2 * t <= near_eps * s2 ) | ( 2 * t <= near_eps * s3 ) ) \
+          & ( ( -2 * t <= near_eps * s1 ) | ( -2 * t <= near_eps * s2 ) | ( -2 * t <= near_eps * s3 ) ) )
+#define UNCERTAIN_SIGN(t, l, r) ( VEC_ABS(t) <= CCW_ERRBOUND_A * ( VEC_ABS(l) + VEC_ABS(r) ) )
+        __auto_type near = NEAR_COLLINEAR(t1, side_ab_sq, side_bc_sq, side_ac_sq)
+                         | NEAR_COLLINEAR(t2, side_ab_sq, side_bd_sq, side_ad_sq)
+                         | NEAR_COLLINEAR(t3, side_cd_sq, side_ad_sq, side_ac_sq)
+                         | NEAR_COLLINEAR(t4, side_cd_sq, side_bd_sq, side_bc_sq)
+        // and where rounding may have flipped a sign, left to the exact orient2d()
+                         | UNCERTAIN_SIGN(t1, abx * ( cy - ay ), ( cx - ax ) * aby)
+                         | UNCERTAIN_SIGN(t2, abx * ( dy - ay ), ( dx - ax ) * aby)
+                         | UNCERTAIN_SIGN(t3, ( dx - cx ) * ( ay - cy ), ( ax - cx ) * ( dy - cy ))
+                         | UNCERTAIN_SIGN(t4, ( dx - cx ) * ( by - cy ), ( bx - cx ) * ( dy - cy ));
+#undef NEAR_COLLINEAR
+#undef UNCERTAIN_SIGN
+#endif
+        __auto_type hit = ~near & ( ( t1 > 0 ) ^ ( t2 > 0 ) ) & ( ( t3 > 0 ) ^ ( t4 > 0 ) );
+        if (VEC_ANY(hit)) {
+            return true;
+        }
+        if (VEC_ANY(near)) {
+            for (vidx_t l = 0; l < KERNEL_LANES; ++l) {
+                if (near[l] && intersects(ax, ay, bx, by, xc[k + l], yc[k + l], xd[k + l], yd[k + l])) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    for (; k < m; ++k) {
+        if (intersects(ax, ay, bx, by, xc[k], yc[k], xd[k], yd[k])) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#undef KERNEL_LANES
@@ -7,6 +7,18 @@
 #define MYIDEF
 #endif
 
+#ifdef POLY2TRI_STATIC_INLINE
+// the hot accessors are then private to each translation unit, free to be inlined
+#define HOTIDEF static inline
+#else
+#define HOTIDEF MYIDEF
+#endif
+
+// one of several instantiations linked together, see poly2tri_instance.h
+#ifdef POLY2TRI_PREFIX
+#include "poly2tri_prefix.h"
+#endif
+
 #include <float.h>
 #include <math.h>
 #include <stdbool.h>
@@ -15,32 +27,97 @@
 #include <stdlib.h>
 #include <string.h>
 
-#ifdef USING_DOUBLE_COORD
+#ifdef USING_INT32_COORD
+typedef int32_t coord_t;
+#elif defined(USING_DOUBLE_COORD)
 typedef double coord_t;
 #else
 typedef float coord_t;
 #endif
 
-#ifdef USING_INT16_INDEX
+#if defined(USING_DOUBLE_PREDICATES) && (defined(USING_DOUBLE_COORD) || defined(USING_INT32_COORD))
+#error "USING_DOUBLE_PREDICATES goes with the float coord_t"
+#endif
+
+#ifdef USING_INT32_COORD
+// (twice) areas and orientation determinants, exact while |x|, |y| < 2^30
+typedef int64_t area_t;
+// derived quantities that are not exact anyway: angles, ratios, tolerances
+typedef double real_t;
+#elif defined(USING_DOUBLE_PREDICATES)
+// float storage, areas and predicates in double: a product of two floats is exact there
+typedef double area_t;
+typedef double real_t;
+#else
+typedef coord_t area_t;
+typedef coord_t real_t;
+#endif
+
+#if defined(USING_INT16_INDEX)
 typedef int16_t vidx_t;
+#define PRIvidx PRId16
+#define VIDX_MAX INT16_MAX
+#elif defined(USING_UINT16_INDEX)
+// GPU index buffers: up to 65535 vertices, the index 65535 stays VIDX_NONE
+typedef uint16_t vidx_t;
+#define PRIvidx PRIu16
+#define VIDX_MAX UINT16_MAX
+#elif defined(USING_INT64_INDEX)
+typedef int64_t vidx_t;
+#define PRIvidx PRId64
+#define VIDX_MAX INT64_MAX
 #else
 typedef int32_t vidx_t;
+#define PRIvidx PRId32
+#define VIDX_MAX INT32_MAX
 #endif
+// no vertex, every bit set, as triangles_allocate() leaves the unused slots
+#define VIDX_NONE ((vidx_t)-1)
 
 #define THE_MIN(a, b) ((a) < (b) ? (a) : (b))
 #define THE_MAX(a, b) ((a) > (b) ? (a) : (b))
 #define THE_ABS(expr) ({__auto_type v = (expr); v >= (__typeof__(v))0 ? v : -v;})
 
-#define REAL_MAX_VALUE(x) _Generic((x), float:FLT_MAX, double: DBL_MAX) 
+#define REAL_MAX_VALUE(x) _Generic((x), float:FLT_MAX, double: DBL_MAX, int32_t: INT32_MAX) 
 
 typedef struct triangles_s* triangles_t;
 
 MYIDEF triangles_t triangles_allocate(vidx_t m);
+// wraps the caller's BUFFER of 3*CAPACITY indices as is, triangles_free() releases only the wrapper
+MYIDEF triangles_t triangles_attach(vidx_t capacity, vidx_t buffer[]);
+// receives NUM triangles TRI[3*NUM], the triangles FIRST .. FIRST+NUM-1 of the stream
+typedef void (*triangles_sink_t)(void* ctx, vidx_t first, vidx_t num, const vidx_t tri[]);
+#define TRIANGLES_STREAM_BATCH 256
+// buffers BATCH triangles at a time and hands each full batch to SINK, triangles_nth() reaches
+// only the triangles not handed over yet; the engines flush the rest before they return.
+// A polygon rejected halfway rolls triangles_num() back no further than the sink was handed.
+MYIDEF triangles_t triangles_stream(vidx_t batch, triangles_sink_t sink, void* ctx);
+MYIDEF void        triangles_flush(triangles_t triangles);
+// the engines fill ADJ[3*t + k] with the triangle across edge k, from vertex k to k+1, of triangle t,
+// VIDX_NONE on the boundary, for the first NUM triangles; ADJ NULL allocates it for the capacity.
+// Replaces the array of an earlier call, freeing it only if it was allocated here
+MYIDEF bool        triangles_adjacency(triangles_t triangles, vidx_t num, vidx_t adj[]);
+// the 3 neighbours of triangle I, NULL without adjacency
+MYIDEF vidx_t*     triangles_nth_adjacent(triangles_t triangles, vidx_t i);
+// the triangles as strips, each strip after the first led by a VIDX_NONE restart index; writes
+// up to NUM indices to STRIP and returns how many it takes, at most TRIANGLES_STRIP_MAX(m).
+// A triangle continues the strip when it is next in order, or anywhere across the open edge with adjacency
+MYIDEF size_t      triangles_strip(triangles_t triangles, size_t num, vidx_t strip[]);
+#define TRIANGLES_STRIP_MAX(m) (4 * (size_t)(m))
+// the post-transform vertex cache misses per triangle of a FIFO cache of CACHE vertices, 0.5 .. 3;
+// 0 without triangles or with an index of N or more
+MYIDEF double      triangles_acmr(triangles_t triangles, vidx_t n, vidx_t cache);
+#define TRIANGLES_VERTEX_CACHE 16
+// reorders the triangles of the N vertices for a vertex cache of CACHE (Tipsify), in linear time,
+// and their adjacency with them; with REMAP renumbers the vertices by first use, REMAP[new] = old,
+// the unused ones last. ACMR, unless NULL, gets triangles_acmr() before and after,
+// and is left as it was when an index is N or more
+MYIDEF bool        triangles_optimize(triangles_t triangles, vidx_t n, vidx_t cache, vidx_t remap[], double acmr[2]);
 MYIDEF void        triangles_free(triangles_t triangles);
 
-MYIDEF vidx_t  triangles_num(triangles_t triangles);
-MYIDEF vidx_t* triangles_nth(triangles_t triangles, vidx_t i);
-MYIDEF vidx_t  triangles_append(triangles_t triangles, vidx_t a, vidx_t b, vidx_t c);
+HOTIDEF vidx_t  triangles_num(triangles_t triangles);
+HOTIDEF vidx_t* triangles_nth(triangles_t triangles, vidx_t i);
+HOTIDEF vidx_t  triangles_append(triangles_t triangles, vidx_t a, vidx_t b, vidx_t c);
 
 
 typedef struct vertices_s* vertices_t;
@@ -48,16 +125,35 @@ typedef struct vertices_s* vertices_t;
 MYIDEF vertices_t vertices_allocate(vidx_t n);
 MYIDEF vertices_t vertices_clone_floats(vidx_t n, const float x[n], const float y[n]);
 MYIDEF vertices_t vertices_clone_doubles(vidx_t n, const double x[n], const double y[n]);
+MYIDEF vertices_t vertices_clone_int32s(vidx_t n, const int32_t x[n], const int32_t y[n]);
 #define vertices_create(n, x, y) _Generic((x), const float*:vertices_clone_floats, float*:vertices_clone_floats,\
-        const double*:vertices_clone_doubles, double*:vertices_clone_doubles)(n,x,y)
+        const double*:vertices_clone_doubles, double*:vertices_clone_doubles,\
+        const int32_t*:vertices_clone_int32s, int32_t*:vertices_clone_int32s)(n,x,y)
 MYIDEF vertices_t vertices_attach(vidx_t n, const coord_t px[n], const coord_t py[n]);
+// interleaved (AoS) buffers, the coord_t x and y of vertex i at base + i * stride + x_off (y_off), no copy
+MYIDEF vertices_t vertices_attach_strided(vidx_t n, const void* base, size_t stride, size_t x_off, size_t y_off);
+// no copy of arrays in another type than coord_t, each read converts with COORD_ROUND() like vertices_create() does
+MYIDEF vertices_t vertices_attach_floats(vidx_t n, const float x[n], const float y[n]);
+MYIDEF vertices_t vertices_attach_doubles(vidx_t n, const double x[n], const double y[n]);
+// a planar 3D ring (with holes), projected onto the coordinate plane the Newell normal is most
+// perpendicular to, keeping the orientation about the normal; normal[3] is optional, no copy
+MYIDEF vertices_t vertices_attach_planar(vidx_t n, const coord_t px[n], const coord_t py[n], const coord_t pz[n], real_t normal[3]);
+#define vertices_view(n, x, y) _Generic((x), const float*:vertices_attach_floats, float*:vertices_attach_floats,\
+        const double*:vertices_attach_doubles, double*:vertices_attach_doubles)(n,x,y)
+// the clones of float storage keep far-out inputs (UTM, web-mercator) relative to their bbox center,
+// vertices_nth_getx() adds it back
+// compact copy: 16-bit offsets in the bbox, in steps of the longer bbox side / 65535, rounded to the nearest step
+MYIDEF vertices_t vertices_quantize(vidx_t n, const coord_t px[n], const coord_t py[n]);
 
 MYIDEF void       vertices_destroy(vertices_t poly);
 
-MYIDEF vidx_t  vertices_num(const vertices_t poly);
-MYIDEF coord_t vertices_nth_getx(const vertices_t cs, vidx_t idx);
-MYIDEF coord_t vertices_nth_gety(const vertices_t cs, vidx_t idx);
-MYIDEF void    vertices_nth_setxy(vertices_t cs, vidx_t idx, coord_t x, coord_t y);
+HOTIDEF vidx_t  vertices_num(const vertices_t poly);
+HOTIDEF coord_t vertices_nth_getx(const vertices_t cs, vidx_t idx);
+HOTIDEF coord_t vertices_nth_gety(const vertices_t cs, vidx_t idx);
+HOTIDEF void    vertices_nth_setxy(vertices_t cs, vidx_t idx, coord_t x, coord_t y);
+// the coordinates the predicates run on: as stored, off the origin of a recentered clone, or the integer offsets of quantized vertices
+HOTIDEF coord_t vertices_nth_localx(const vertices_t cs, vidx_t idx);
+HOTIDEF coord_t vertices_nth_localy(const vertices_t cs, vidx_t idx);
 
 
 typedef struct holes_s* holes_t;
@@ -65,8 +161,12 @@ typedef struct holes_s* holes_t;
 //MYIDEF holes_t holes_create(vidx_t num, vidx_t holeIndices[num]);
 MYIDEF holes_t holes_create_int16(int16_t num, const int16_t holeIndices[num]);
 MYIDEF holes_t holes_create_int32(int32_t num, const int32_t holeIndices[num]);
+MYIDEF holes_t holes_create_uint16(uint16_t num, const uint16_t holeIndices[num]);
+MYIDEF holes_t holes_create_int64(int64_t num, const int64_t holeIndices[num]);
 #define holes_create(num, holeIndices) _Generic((num), const int16_t:holes_create_int16, int16_t:holes_create_int16, \
-        const int32_t:holes_create_int32, int32_t:holes_create_int32)(num, holeIndices)
+        const int32_t:holes_create_int32, int32_t:holes_create_int32, \
+        const uint16_t:holes_create_uint16, uint16_t:holes_create_uint16, \
+        const int64_t:holes_create_int64, int64_t:holes_create_int64)(num, holeIndices)
 
 MYIDEF void    holes_destory(holes_t holes);
 
@@ -77,45 +177,395 @@ typedef struct polygon_s* polygon_t;
 MYIDEF polygon_t polygon_build(const vertices_t vertices, const holes_t holes);
 MYIDEF void polygon_destroy(polygon_t polygon);
 
-MYIDEF coord_t polygon_area(polygon_t polygon);
+MYIDEF area_t polygon_area(polygon_t polygon);
 MYIDEF vertices_t polygon_getvertices(polygon_t polygon);
 
-MYIDEF coord_t signed_area(const vertices_t cs, vidx_t start, vidx_t end);
-MYIDEF coord_t triangle_area(const coord_t xa, const coord_t ya, const coord_t xb, const coord_t yb, const coord_t xc, const coord_t yc);
+// in the local coordinates, see vertices_nth_localx()
+MYIDEF area_t  signed_area(const vertices_t cs, vidx_t start, vidx_t end);
+MYIDEF void    signed_areas(const vertices_t cs, const holes_t holes, area_t areas[]);
+HOTIDEF area_t  triangle_area(const coord_t xa, const coord_t ya, const coord_t xb, const coord_t yb, const coord_t xc, const coord_t yc);
+// twice the signed area of abc, positive when counterclockwise, with an exact sign
+HOTIDEF area_t  orient2d(const coord_t ax, const coord_t ay, const coord_t bx, const coord_t by, const coord_t cx, const coord_t cy);
+#ifndef USING_INT32_COORD
+// the expansion orient2d() falls back on when its error bound can't decide the sign
+MYIDEF area_t  orient2d_exact(const area_t ax, const area_t ay, const area_t bx, const area_t by, const area_t cx, const area_t cy);
+#endif
+
+MYIDEF real_t  angle_degree(const coord_t x1, const coord_t y1, const coord_t x2, const coord_t y2, const coord_t x3, const coord_t y3);
+
+// vertex angle tolerance, about 1 millionth radian
+#define ANGLE_TOL_DEGREE 5.7E-05
+
+enum {
+    VERTICES_VALID,
+    VERTICES_TOO_FEW,       // less than 3 vertices
+    VERTICES_DUPLICATE,     // two consecutive vertices are identical
+    VERTICES_SHARP_ANGLE,   // a vertex angle is not larger than ANGLE_TOL_DEGREE
+};
+
+MYIDEF int vertices_validate(const vertices_t cs, vidx_t start, vidx_t end, area_t* area, vidx_t* at);
 
-MYIDEF coord_t angle_degree(const coord_t x1, const coord_t y1, const coord_t x2, const coord_t y2, const coord_t x3, const coord_t y3);
+// flags of the polygon_*_ex entry points
+enum {
+    POLY2TRI_VALIDATE = 1 << 0,     // run vertices_validate on every ring before triangulating
+    POLY2TRI_TRUSTED  = 1 << 1,     // the vertices are known to be valid, skip every check
+    POLY2TRI_ADJACENCY = 1 << 2,    // the returned triangles come with triangles_nth_adjacent()
+    POLY2TRI_MORTON   = 1 << 3,     // polygon_earcut: the triangles in z-order of their centroids, not for a stream
+};
+// polygon_triangulate: classify the initial ears on N threads, kept in bits 8..15 of the flags;
+// at most POLY2TRI_THREADS_MAX run, without it the calling thread does it alone
+#define POLY2TRI_THREADS(n) ((unsigned)THE_MIN(THE_MAX((n), 1), 255) << 8)
+#define POLY2TRI_THREADS_OF(flags) ((int)((flags) >> 8 & 0xff))
+#define POLY2TRI_THREADS_MAX 64
 
 MYIDEF bool between(const coord_t xa, const coord_t ya, const coord_t xb, const coord_t yb, const coord_t xc, const coord_t yc);
 MYIDEF bool intersects(const coord_t xa, const coord_t ya, const coord_t xb, const coord_t yb,
                        const coord_t xc, const coord_t yc, const coord_t xd, const coord_t yd);
+// same as intersects() of A:B against any of the M segments C[k]:D[k], evaluated a vector of segments at a time
+MYIDEF bool intersects_any(const coord_t xa, const coord_t ya, const coord_t xb, const coord_t yb, vidx_t m,
+                           const coord_t xc[m], const coord_t yc[m], const coord_t xd[m], const coord_t yd[m]);
+
+// levels of the vector kernels in signed_area(), vertices_validate() and intersects_any()
+enum {
+    GEOMETRY_SIMD_AUTO = -1,        // the best the CPU supports, unless POLY2TRI_SIMD names a level
+    GEOMETRY_SIMD_BASELINE,         // as compiled, SSE2 on a plain x86-64 build
+    GEOMETRY_SIMD_AVX2,
+    GEOMETRY_SIMD_AVX512,
+};
+// binds LEVEL, capped at what the CPU supports, and returns the level bound;
+// the first kernel call binds GEOMETRY_SIMD_AUTO otherwise
+MYIDEF int geometry_simd_set_level(int level);
+MYIDEF int geometry_simd_get_level(void);
 
 #endif // POLY2TRI_INCLUDE_GEOMETRY_TYPE_H
 
-#ifdef GEOM_TYPE_IMPLEMENTATION
+#if (defined(POLY2TRI_STATIC_INLINE) || defined(GEOM_TYPE_IMPLEMENTATION)) && !defined(GEOM_TYPE_HOT_DEFINED)
+// the layouts and the accessors each triangulation step goes through, ahead of the
+// implementation or, under POLY2TRI_STATIC_INLINE, in every translation unit
+#define GEOM_TYPE_HOT_DEFINED
+
+enum {
+    VERTICES_SOA,           // x0 + px[], y0 + py[]
+    VERTICES_QUANTIZED,     // x0 + step * qx[], y0 + step * qy[]
+    VERTICES_STRIDED,       // base[i * stride + xoff], base[i * stride + yoff]
+    VERTICES_FLOATS,        // (coord_t)fx[], (coord_t)fy[], when coord_t isn't float
+    VERTICES_DOUBLES,       // (coord_t)dx[], (coord_t)dy[], when coord_t isn't double
+};
 
-#define COORD_X_SZ sizeof(coord_t)
-#define COORD_Y_SZ sizeof(coord_t)
+#define VERTICES_QUANT_MAX 65535
 
 struct vertices_s {
     union {
         const vidx_t n;
         vidx_t N;
     };
-    struct {
-        const coord_t *px;
-        const coord_t *py;
+    int layout;
+    // origin of the local coordinates, 0 unless a clone or quantized copy moved it
+    real_t x0, y0;
+    union {
+        struct {
+            const coord_t *px;
+            const coord_t *py;
+        };
+        struct {
+            const uint16_t *qx;
+            const uint16_t *qy;
+            real_t step;
+        };
+        struct {
+            const unsigned char *base;
+            size_t stride, xoff, yoff;
+        };
+        struct {
+            const float *fx;
+            const float *fy;
+        };
+        struct {
+            const double *dx;
+            const double *dy;
+        };
     };
     alignas(8) coord_t vertices[0];
 };
 
-struct holes_s {
-    vidx_t num;
-    alignas(8) vidx_t holeIndices[];
-};
+// every conversion into coord_t: clones, views and vertices_nth_setxy() round the same way
+#ifdef USING_INT32_COORD
+#define COORD_ROUND(v) ((coord_t)lround(v))
+#else
+#define COORD_ROUND(v) ((coord_t)(v))
+#endif
 
 struct triangles_s {
     vidx_t m;
-    alignas(8) vidx_t vidx[];
+    vidx_t capacity;    // triangles vidx holds, m counts on past it but stores nothing there
+    vidx_t base;        // triangles handed to the sink, vidx starts at triangle base
+    vidx_t* vidx;   // points to the trailing storage unless it wraps a caller's buffer
+    triangles_sink_t sink;
+    void* ctx;
+    vidx_t adj_num;     // triangles adj has room for
+    bool adj_owned;
+    vidx_t* adj;        // the neighbours, NULL unless asked for
+    alignas(8) vidx_t storage[];
+};
+
+// more triangles than the buffer holds, never so for a stream
+#define TRIANGLES_OVERFLOWED(t) ((t)->sink == NULL && (t)->m - (t)->base > (t)->capacity)
+// back to M0, as far as the sink hasn't seen them yet
+#define TRIANGLES_ROLLBACK(t, m0) ((t)->m = THE_MAX((vidx_t)(m0), (t)->base))
+
+HOTIDEF vidx_t triangles_num(triangles_t triangles) {
+    return triangles->m;
+}
+
+HOTIDEF vidx_t* triangles_nth(triangles_t triangles, vidx_t i) {
+    return &triangles->vidx[(i - triangles->base) * 3];
+}
+
+HOTIDEF vidx_t triangles_append(triangles_t triangles, vidx_t a, vidx_t b, vidx_t c) {
+    vidx_t i = triangles->m;
+    if (i - triangles->base >= triangles->capacity && triangles->sink != NULL) {
+        // the cold path of a stream, a full batch goes out
+        triangles_flush(triangles);
+    }
+    // a full buffer only counts, the engines check m against the capacity once at the end
+    if (i - triangles->base < triangles->capacity) {
+        __auto_type tri = triangles_nth(triangles, i);
+        tri[0] = a;
+        tri[1] = b;
+        tri[2] = c;
+    }
+    triangles->m = i + 1;
+    return triangles->m;
+}
+
+HOTIDEF vidx_t vertices_num(const vertices_t poly) {
+    return poly->n;
+}
+
+HOTIDEF coord_t vertices_nth_getx(const vertices_t cs, vidx_t idx) {
+    if (cs->layout == VERTICES_QUANTIZED) {
+        return COORD_ROUND(cs->x0 + cs->step * cs->qx[idx]);
+    }
+    return COORD_ROUND(cs->x0 + vertices_nth_localx(cs, idx));
+}
+
+HOTIDEF coord_t vertices_nth_gety(const vertices_t cs, vidx_t idx) {
+    if (cs->layout == VERTICES_QUANTIZED) {
+        return COORD_ROUND(cs->y0 + cs->step * cs->qy[idx]);
+    }
+    return COORD_ROUND(cs->y0 + vertices_nth_localy(cs, idx));
+}
+
+// nearest step, clamped into the 16 bits
+#define QUANTIZE(v, v0, step) ({ real_t q_ = ((real_t)(v) - (v0)) / (step) + (real_t)0.5; \
+        (uint16_t)(q_ <= 0 ? 0 : q_ >= VERTICES_QUANT_MAX ? VERTICES_QUANT_MAX : q_); })
+
+HOTIDEF void vertices_nth_setxy(vertices_t cs, vidx_t idx, coord_t x, coord_t y) {
+    if (cs->layout == VERTICES_QUANTIZED) {
+        uint16_t* q = (uint16_t*)cs->vertices;
+        q[idx] = QUANTIZE(x, cs->x0, cs->step);
+        q[cs->n + idx] = QUANTIZE(y, cs->y0, cs->step);
+        return;
+    }
+    cs->vertices[idx] = COORD_ROUND(x - cs->x0);
+    cs->vertices[cs->n + idx] = COORD_ROUND(y - cs->y0);
+}
+
+// the caller's records need not align coord_t, memcpy compiles to a plain load
+#define STRIDED_NTH(cs, idx, off) ({ coord_t v_; \
+        memcpy(&v_, (cs)->base + (size_t)(idx) * (cs)->stride + (off), sizeof(v_)); v_; })
+
+HOTIDEF coord_t vertices_nth_localx(const vertices_t cs, vidx_t idx) {
+    switch (cs->layout) {
+    case VERTICES_QUANTIZED:
+        return (coord_t)cs->qx[idx];
+    case VERTICES_STRIDED:
+        return STRIDED_NTH(cs, idx, cs->xoff);
+    case VERTICES_FLOATS:
+        return COORD_ROUND(cs->fx[idx]);
+    case VERTICES_DOUBLES:
+        return COORD_ROUND(cs->dx[idx]);
+    default:
+        return cs->px[idx];
+    }
+}
+
+HOTIDEF coord_t vertices_nth_localy(const vertices_t cs, vidx_t idx) {
+    switch (cs->layout) {
+    case VERTICES_QUANTIZED:
+        return (coord_t)cs->qy[idx];
+    case VERTICES_STRIDED:
+        return STRIDED_NTH(cs, idx, cs->yoff);
+    case VERTICES_FLOATS:
+        return COORD_ROUND(cs->fy[idx]);
+    case VERTICES_DOUBLES:
+        return COORD_ROUND(cs->dy[idx]);
+    default:
+        return cs->py[idx];
+    }
+}
+
+#ifdef USING_INT32_COORD
+/**
+ * Integer coordinates: the determinant is taken in 64 bits, exact and branch-free
+ * while the coordinates stay within +-2^30.
+ */
+HOTIDEF area_t orient2d(const coord_t ax, const coord_t ay, const coord_t bx, const coord_t by, const coord_t cx, const coord_t cy)
+{
+    return (area_t)(ax - cx) * (by - cy) - (area_t)(ay - cy) * (bx - cx);
+}
+#else
+/**
+ * Adaptive orientation test after Shewchuk, "Adaptive Precision Floating-Point
+ * Arithmetic and Fast Robust Geometric Predicates", 1997, carried out in area_t.
+ * The plain determinant is returned whenever its error bound proves the sign right,
+ * otherwise the determinant is re-evaluated exactly as a floating-point expansion.
+ * Relies on round-to-nearest without excess precision; orient2d_exact() turns contraction off itself.
+ */
+#if defined(USING_DOUBLE_COORD) || defined(USING_DOUBLE_PREDICATES)
+#define PRED_EPSILON 1.1102230246251565e-16 // 2^-53
+#define PRED_SPLITTER 134217729.0           // 2^27 + 1
+#else
+#define PRED_EPSILON 5.9604645e-08f         // 2^-24
+#define PRED_SPLITTER 4097.0f               // 2^12 + 1
+#endif
+#define CCW_ERRBOUND_A ((3 + 16 * PRED_EPSILON) * PRED_EPSILON)
+
+HOTIDEF area_t  orient2d(const coord_t ax, const coord_t ay, const coord_t bx, const coord_t by, const coord_t cx, const coord_t cy)
+{
+    area_t detleft = ((area_t)ax - cx) * ((area_t)by - cy);
+    area_t detright = ((area_t)ay - cy) * ((area_t)bx - cx);
+#if defined(USING_DOUBLE_PREDICATES) && defined(FP_FAST_FMA)
+    // one rounding less, the error bound below still holds
+    area_t det = fma((area_t)ax - cx, (area_t)by - cy, -detright);
+#else
+    area_t det = detleft - detright;
+#endif
+    area_t detsum;
+
+    if (detleft > 0) {
+        if (detright <= 0) {
+            return det;
+        }
+        detsum = detleft + detright;
+    }
+    else if (detleft < 0) {
+        if (detright >= 0) {
+            return det;
+        }
+        detsum = -detleft - detright;
+    }
+    else {
+        return det;
+    }
+
+    area_t errbound = CCW_ERRBOUND_A * detsum;
+    if (det >= errbound || -det >= errbound) {
+        return det;
+    }
+    return orient2d_exact(ax, ay, bx, by, cx, cy);
+}
+#endif // USING_INT32_COORD
+
+/**
+  Purpose:
+    TRIANGLE_AREA computes the signed area of a triangle.
+    The signed area of a triangle is just the area of a triangle, if the vertices are listed counterclockwise,
+    or negative of that area, if the vertices are listed clockwise.
+
+  Modified:
+    05 May 2014
+
+  Author:
+    John Burkardt
+
+  Parameters:
+    Input, double XA, YA, XB, YB, XC, YC, the coordinates of
+    the vertices of the triangle, given in counterclockwise order.
+
+    Output, double TRIANGLE_AREA, the signed area of the triangle.
+    Twice the area actually, its sign is exact, see ORIENT2D.
+*/
+HOTIDEF area_t triangle_area(const coord_t ax, const coord_t ay, const coord_t bx, const coord_t by, const coord_t cx, const coord_t cy)
+{
+    return /*0.5 * */ orient2d(ax, ay, bx, by, cx, cy);
+}
+
+#endif // GEOM_TYPE_HOT_DEFINED
+
+#if defined(GEOM_TYPE_IMPLEMENTATION) && !defined(GEOM_TYPE_IMPLEMENTED)
+// once per translation unit, both engines ask for it
+#define GEOM_TYPE_IMPLEMENTED
+
+#define COORD_X_SZ sizeof(coord_t)
+#define COORD_Y_SZ sizeof(coord_t)
+
+// the baseline width of a coord_t vector, see geometry_kernels.h for the others
+#ifdef __AVX512F__
+#define COORD_VEC_BYTES 64
+#else
+#define COORD_VEC_BYTES 32
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#define GEOMETRY_SIMD_X86 1
+#else
+#define GEOMETRY_SIMD_X86 0
+#endif
+// as many coord_t as V has lanes, loaded from P and converted to V's lane type
+#define AREAV_LOAD(v, p) do { \
+        coord_t l_ __attribute__((vector_size(sizeof(v) / sizeof((v)[0]) * sizeof(coord_t)))); \
+        memcpy(&l_, (p), sizeof(l_)); \
+        (v) = __builtin_convertvector(l_, __typeof__(v)); } while (0)
+#define VEC_ANY(m) ({ bool any_ = false; \
+        for (size_t k_ = 0; k_ < sizeof(m) / sizeof((m)[0]); ++k_) any_ |= (m)[k_] != 0; \
+        any_; })
+// pairwise sum of the lanes
+#define VEC_REDUCE(v) ({ __auto_type r_ = (v); \
+        for (size_t w_ = sizeof(r_) / sizeof(r_[0]) / 2; w_ > 0; w_ /= 2) \
+            for (size_t k_ = 0; k_ < w_; ++k_) r_[k_] += r_[k_ + w_]; \
+        r_[0]; })
+// lane-wise |v|, the comparison mask is -1 on negative lanes
+#define VEC_ABS(v) ({ __auto_type v_ = (v); v_ * (1 + 2 * __builtin_convertvector(v_ < 0, __typeof__(v_))); })
+// compensated (Kahan) summation step, lane-wise on vectors
+#define KAHAN_ADD(sum, comp, term) do { __auto_type y_ = (term) - (comp); __auto_type t_ = (sum) + y_; \
+        (comp) = (t_ - (sum)) - y_; (sum) = t_; } while (0)
+
+// the kernels of one SIMD level, bound at first use, see geometry_simd_set_level()
+struct geom_kernels_s {
+    int level;
+    area_t (*ring_area)(const coord_t px[], const coord_t py[], vidx_t* at, vidx_t end);
+    area_t (*ring_validate)(const coord_t px[], const coord_t py[], vidx_t* at, vidx_t end);
+    bool (*intersects_any)(const coord_t ax, const coord_t ay, const coord_t bx, const coord_t by, vidx_t m,
+                           const coord_t xc[], const coord_t yc[], const coord_t xd[], const coord_t yd[]);
+};
+static const struct geom_kernels_s* geom_kernels(void);
+
+// float storage only: a product of far-out coordinates loses the digits the predicates need
+#if !defined(USING_DOUBLE_COORD) && !defined(USING_INT32_COORD)
+#define RECENTER_BUILD 1
+#define RECENTER_WANTED(cx, cy, extent) (THE_MAX(THE_ABS(cx), THE_ABS(cy)) > (extent))
+#else
+#define RECENTER_BUILD 0
+#define RECENTER_WANTED(cx, cy, extent) ((void)(cx), (void)(cy), (void)(extent), false)
+#endif
+
+// the bbox center of x[], y[] into OX, OY when it lies farther out than the bbox is wide, else 0
+#define RECENTER_ORIGIN(n, x, y, ox, oy) do { \
+        __typeof__((x)[0] + (real_t)0) minx_ = 0, maxx_ = 0, miny_ = 0, maxy_ = 0; \
+        if ((n) > 0) { minx_ = maxx_ = (x)[0]; miny_ = maxy_ = (y)[0]; } \
+        for (vidx_t i_ = 1; i_ < (n); ++i_) { \
+            minx_ = THE_MIN(minx_, (x)[i_]); maxx_ = THE_MAX(maxx_, (x)[i_]); \
+            miny_ = THE_MIN(miny_, (y)[i_]); maxy_ = THE_MAX(maxy_, (y)[i_]); \
+        } \
+        __auto_type cx_ = (minx_ + maxx_) / 2; \
+        __auto_type cy_ = (miny_ + maxy_) / 2; \
+        bool far_ = RECENTER_WANTED(cx_, cy_, THE_MAX(maxx_ - minx_, maxy_ - miny_)); \
+        (ox) = far_ ? (real_t)cx_ : 0; \
+        (oy) = far_ ? (real_t)cy_ : 0; } while (0)
+
+struct holes_s {
+    vidx_t num;
+    alignas(8) vidx_t holeIndices[];
 };
 
 struct polygon_s {
@@ -142,19 +592,21 @@ MYIDEF void polygon_destroy(polygon_t polygon) {
     free(polygon);
 }
 
-MYIDEF coord_t polygon_area(polygon_t polygon) {
-    holes_t holes = polygon->holes;
-    bool hasHole = holes != NULL;
-    
-    vidx_t holeStart = hasHole ? holes->holeIndices[0] : vertices_num(polygon->vertices);
-    __auto_type sarea = THE_ABS(signed_area(polygon->vertices, 0, holeStart));
+MYIDEF area_t polygon_area(polygon_t polygon) {
+    const vertices_t cs = polygon->vertices;
+    const holes_t holes = polygon->holes;
+    const vidx_t num = holes != NULL ? holes->num : 0;
+
+    // one signed_area() per ring, the outer one straight into SAREA, the holes summed without an array
+    __auto_type sarea = THE_ABS(signed_area(cs, 0, num > 0 ? holes->holeIndices[0] : cs->n));
     __auto_type sum = (__typeof__(sarea))0;
-    if (hasHole) {
-        for (vidx_t i = 0; i < holes->num; ++i) {
-            vidx_t start = holes->holeIndices[i];
-            vidx_t end = i < holes->num - 1 ? holes->holeIndices[i + 1] : vertices_num(polygon->vertices);
-            sum += THE_ABS(signed_area(polygon->vertices, start, end));
-        }
+    for (vidx_t r = 0; r < num; ++r) {
+        vidx_t end = r < num - 1 ? holes->holeIndices[r + 1] : cs->n;
+        sum += THE_ABS(signed_area(cs, holes->holeIndices[r], end));
+    }
+    if (cs->layout == VERTICES_QUANTIZED) {
+        // back from square steps
+        return (area_t)((sarea - sum) * cs->step * cs->step);
     }
     return sarea - sum;
 }
@@ -166,86 +618,490 @@ MYIDEF vertices_t polygon_getvertices(polygon_t polygon) {
 MYIDEF triangles_t triangles_allocate(vidx_t m) {
     triangles_t triangles =
         (__typeof__(triangles)) aligned_alloc(8, sizeof(*triangles) + m * 3 * sizeof(vidx_t));
-    triangles->m = 0;
+    *triangles = (struct triangles_s) {
+        .capacity = m,
+        .vidx = triangles->storage,
+    };
+    // the unused slots read as VIDX_NONE, whatever the width and signedness of vidx_t
     memset(triangles->vidx, -1, m * 3 * sizeof(vidx_t));
     return triangles;
 }
 
-MYIDEF void triangles_free(triangles_t triangles) {
-    free(triangles);
+MYIDEF triangles_t triangles_attach(vidx_t capacity, vidx_t buffer[]) {
+    triangles_t triangles = (__typeof__(triangles)) aligned_alloc(8, sizeof(*triangles));
+    *triangles = (struct triangles_s) {
+        .capacity = capacity,
+        // no fill, the caller's memory may well be write-combined
+        .vidx = buffer,
+    };
+    return triangles;
 }
 
-MYIDEF vidx_t triangles_num(triangles_t triangles) {
-    return triangles->m;
+MYIDEF triangles_t triangles_stream(vidx_t batch, triangles_sink_t sink, void* ctx) {
+    triangles_t triangles =
+        (__typeof__(triangles)) aligned_alloc(8, sizeof(*triangles) + batch * 3 * sizeof(vidx_t));
+    *triangles = (struct triangles_s) {
+        .capacity = batch,
+        .vidx = triangles->storage,
+        .sink = sink,
+        .ctx = ctx,
+    };
+    return triangles;
 }
 
-MYIDEF vidx_t* triangles_nth(triangles_t triangles, vidx_t i) {
-    return &triangles->vidx[i * 3];
+MYIDEF void triangles_flush(triangles_t triangles) {
+    vidx_t num = triangles->m - triangles->base;
+    if (triangles->sink == NULL || num == 0) {
+        return;
+    }
+    triangles->sink(triangles->ctx, triangles->base, num, triangles->vidx);
+    triangles->base = triangles->m;
 }
 
-MYIDEF vidx_t triangles_append(triangles_t triangles, vidx_t a, vidx_t b, vidx_t c) {
-    vidx_t i = triangles->m;
-    __auto_type tri = triangles_nth(triangles, i);
-    tri[0] = a;
-    tri[1] = b;
-    tri[2] = c;
-    triangles->m = i + 1;
-    return triangles->m;
+MYIDEF bool triangles_adjacency(triangles_t triangles, vidx_t num, vidx_t adj[]) {
+    // whatever was attached before goes, the caller's array stays the caller's
+    if (triangles->adj_owned) {
+        free(triangles->adj);
+    }
+    triangles->adj_owned = false;
+    triangles->adj_num = 0;
+    triangles->adj = NULL;
+    if (adj == NULL) {
+        // the triangles of a stream don't stay, their number isn't known up front
+        if (triangles->sink != NULL) {
+            return false;
+        }
+        num = triangles->capacity;
+        adj = (vidx_t*) malloc(3 * (size_t)num * sizeof(vidx_t));
+        if (adj == NULL) {
+            return false;
+        }
+        triangles->adj_owned = true;
+    }
+    triangles->adj_num = num;
+    triangles->adj = adj;
+    return true;
+}
+
+MYIDEF vidx_t* triangles_nth_adjacent(triangles_t triangles, vidx_t i) {
+    return triangles->adj != NULL ? &triangles->adj[3 * (size_t)i] : NULL;
+}
+
+// a half-edge, edge k of triangle t, as 3*t + k
+#define HALF_NONE SIZE_MAX
+
+// edge K of the new triangle T lies against the half-edge ACROSS, HALF_NONE when there is none (yet);
+// both sides get linked, a side past the room of adj keeps VIDX_NONE
+static inline void triangles_link(triangles_t triangles, vidx_t t, int k, size_t across) {
+    const size_t room = 3 * (size_t)triangles->adj_num;
+    const size_t h = 3 * (size_t)t + k;
+    if (h < room) {
+        triangles->adj[h] = across != HALF_NONE && across < room ? (vidx_t)(across / 3) : VIDX_NONE;
+    }
+    if (across != HALF_NONE && across < room) {
+        triangles->adj[across] = h < room ? t : VIDX_NONE;
+    }
+}
+
+// the rotation of TRI that starts with the edge A:B, -1 when it has no such edge
+static inline int triangle_edge(const vidx_t tri[3], vidx_t a, vidx_t b) {
+    for (int k = 0; k < 3; ++k) {
+        if (tri[k] == a && tri[(k + 1) % 3] == b) return k;
+    }
+    return -1;
+}
+
+// the unused triangle after T with the edge A:B, which T holds as B:A; VIDX_NONE when there is none
+static vidx_t strip_next(triangles_t triangles, const bool used[], vidx_t t, vidx_t a, vidx_t b) {
+    vidx_t u = t + 1;
+    if (triangles->adj != NULL) {
+        const int k = triangle_edge(triangles_nth(triangles, t), b, a);
+        u = k >= 0 && t < triangles->adj_num ? triangles->adj[3 * (size_t)t + k] : VIDX_NONE;
+    }
+    if (u == VIDX_NONE || u < triangles->base || u >= triangles->m || used[u - triangles->base]
+        || triangle_edge(triangles_nth(triangles, u), a, b) < 0) {
+        return VIDX_NONE;
+    }
+    return u;
+}
+
+MYIDEF size_t triangles_strip(triangles_t triangles, size_t num, vidx_t strip[]) {
+    if (TRIANGLES_OVERFLOWED(triangles)) {
+        return 0;
+    }
+    const vidx_t base = triangles->base;
+    bool* used = (bool*) calloc((size_t)(triangles->m - base) + 1, sizeof(bool));
+    if (used == NULL) {
+        return 0;
+    }
+    size_t len = 0;
+#define STRIP_PUT(v) do { if (len < num) strip[len] = (v); ++len; } while (0)
+    for (vidx_t s = base; s < triangles->m; ++s) {
+        if (used[s - base]) continue;
+        const vidx_t* tri = triangles_nth(triangles, s);
+        used[s - base] = true;
+        // lead with the rotation whose last edge goes on, if any does
+        int r = 0;
+        for (int k = 0; k < 3; ++k) {
+            if (strip_next(triangles, used, s, tri[(k + 2) % 3], tri[(k + 1) % 3]) != VIDX_NONE) {
+                r = k;
+                break;
+            }
+        }
+        if (len > 0) STRIP_PUT(VIDX_NONE);
+        STRIP_PUT(tri[r]);
+        STRIP_PUT(tri[(r + 1) % 3]);
+        STRIP_PUT(tri[(r + 2) % 3]);
+
+        // P:Q the last two, every other triangle of a strip winds the other way round
+        vidx_t p = tri[(r + 1) % 3], q = tri[(r + 2) % 3];
+        bool odd = true;
+        for (vidx_t t = s, u; (u = odd ? strip_next(triangles, used, t, q, p) : strip_next(triangles, used, t, p, q)) != VIDX_NONE; t = u) {
+            const vidx_t* next = triangles_nth(triangles, u);
+            const int k = odd ? triangle_edge(next, q, p) : triangle_edge(next, p, q);
+            used[u - base] = true;
+            p = q;
+            q = next[(k + 2) % 3];
+            STRIP_PUT(q);
+            odd = !odd;
+        }
+    }
+#undef STRIP_PUT
+    free(used);
+    return len;
+}
+
+// moves the triangles ORDER[0 .. NUM), a permutation of FIRST .. FIRST+NUM-1, to FIRST on,
+// their adjacency along; the neighbours of those triangles are among them
+static bool triangles_permute(triangles_t triangles, vidx_t first, vidx_t num, const vidx_t order[]) {
+    vidx_t* vidx = (vidx_t*) malloc(3 * (size_t)num * sizeof(vidx_t));
+    vidx_t* inverse = (vidx_t*) malloc((size_t)num * sizeof(vidx_t));
+    if (vidx == NULL || inverse == NULL) {
+        free(inverse);
+        free(vidx);
+        return false;
+    }
+    for (vidx_t t = 0; t < num; ++t) {
+        memcpy(&vidx[3 * (size_t)t], triangles_nth(triangles, order[t]), 3 * sizeof(vidx_t));
+    }
+    memcpy(triangles_nth(triangles, first), vidx, 3 * (size_t)num * sizeof(vidx_t));
+
+    if (triangles->adj != NULL && triangles->adj_num >= first + num) {
+        for (vidx_t t = 0; t < num; ++t) {
+            inverse[order[t] - first] = first + t;
+        }
+        for (vidx_t t = 0; t < num; ++t) {
+            for (int k = 0; k < 3; ++k) {
+                const vidx_t a = triangles->adj[3 * (size_t)order[t] + k];
+                vidx[3 * (size_t)t + k] = a == VIDX_NONE || a < first || a >= first + num ? a : inverse[a - first];
+            }
+        }
+        memcpy(&triangles->adj[3 * (size_t)first], vidx, 3 * (size_t)num * sizeof(vidx_t));
+    }
+    free(inverse);
+    free(vidx);
+    return true;
+}
+
+MYIDEF double triangles_acmr(triangles_t triangles, vidx_t n, vidx_t cache) {
+    const vidx_t m = triangles_num(triangles) - triangles->base;
+    if (m == 0 || TRIANGLES_OVERFLOWED(triangles)) {
+        return 0;
+    }
+    // the miss that loaded each vertex, 0 for never; it is still in the FIFO for CACHE more misses
+    size_t* loaded = (size_t*) calloc((size_t)n, sizeof(size_t));
+    if (loaded == NULL) {
+        return 0;
+    }
+    size_t misses = 0;
+    for (vidx_t t = triangles->base; t < triangles->m; ++t) {
+        const vidx_t* tri = triangles_nth(triangles, t);
+        for (int k = 0; k < 3; ++k) {
+            if ((size_t)tri[k] >= (size_t)n) {
+                free(loaded);
+                return 0;
+            }
+            if (loaded[tri[k]] == 0 || misses - loaded[tri[k]] >= (size_t)cache) {
+                loaded[tri[k]] = ++misses;
+            }
+        }
+    }
+    free(loaded);
+    return (double)misses / m;
+}
+
+// Tipsify's next fanning vertex: of the vertices CANDS just emitted the one still live that stays
+// in the cache through its remaining triangles and entered it first, else a live one off the dead-end
+// stack, else the next live one in input order; VIDX_NONE when all is emitted
+static vidx_t tipsify_next(const vidx_t live[], const size_t stamp[], size_t now, vidx_t cache,
+                           size_t ncands, const vidx_t cands[], size_t* ndead, const vidx_t dead[],
+                           vidx_t* cursor, vidx_t n) {
+    vidx_t best = VIDX_NONE;
+    size_t priority = 0;
+    for (size_t c = 0; c < ncands; ++c) {
+        const vidx_t v = cands[c];
+        if (live[v] == 0) continue;
+        // the age it would reach, only if fanning it keeps it in the cache
+        size_t p = 0;
+        if (now - stamp[v] + 2 * (size_t)live[v] <= (size_t)cache) p = now - stamp[v];
+        if (best == VIDX_NONE || p > priority) {
+            best = v;
+            priority = p;
+        }
+    }
+    if (best != VIDX_NONE) return best;
+
+    while (*ndead > 0) {
+        const vidx_t v = dead[--*ndead];
+        if (live[v] > 0) return v;
+    }
+    for (; *cursor < n; ++*cursor) {
+        if (live[*cursor] > 0) return *cursor;
+    }
+    return VIDX_NONE;
+}
+
+MYIDEF bool triangles_optimize(triangles_t triangles, vidx_t n, vidx_t cache, vidx_t remap[], double acmr[2]) {
+    // the triangles of a stream are gone
+    if (triangles->sink != NULL || TRIANGLES_OVERFLOWED(triangles)) {
+        return false;
+    }
+    const vidx_t m = triangles->m;
+
+    // the triangles of each vertex, TRIS[first[v] .. first[v + 1]]
+    size_t* first = (size_t*) calloc((size_t)n + 1, sizeof(size_t));
+    vidx_t* tris = (vidx_t*) malloc(3 * (size_t)m * sizeof(vidx_t));
+    vidx_t* live = (vidx_t*) calloc((size_t)n, sizeof(vidx_t));
+    size_t* stamp = (size_t*) calloc((size_t)n, sizeof(size_t));
+    vidx_t* dead = (vidx_t*) malloc(3 * (size_t)m * sizeof(vidx_t));
+    vidx_t* order = (vidx_t*) malloc((size_t)m * sizeof(vidx_t));
+    bool* emitted = (bool*) calloc((size_t)m + 1, sizeof(bool));
+    bool ok = first != NULL && tris != NULL && live != NULL && stamp != NULL
+        && dead != NULL && order != NULL && emitted != NULL;
+    for (vidx_t t = 0; ok && t < m; ++t) {
+        const vidx_t* tri = triangles_nth(triangles, t);
+        for (int k = 0; k < 3; ++k) {
+            if ((size_t)tri[k] >= (size_t)n) {
+                ok = false;
+                break;
+            }
+            live[tri[k]]++;
+        }
+    }
+    if (!ok) {
+        goto cleanup;
+    }
+    if (acmr != NULL) acmr[0] = acmr[1] = triangles_acmr(triangles, n, cache);
+    if (m == 0) {
+        goto cleanup;
+    }
+    for (vidx_t v = 0; v < n; ++v) {
+        first[v + 1] = first[v] + live[v];
+    }
+    for (vidx_t t = 0; t < m; ++t) {
+        const vidx_t* tri = triangles_nth(triangles, t);
+        for (int k = 0; k < 3; ++k) {
+            tris[first[tri[k]]++] = t;
+        }
+    }
+    // the fill moved FIRST one vertex on
+    for (vidx_t v = n; v > 0; --v) {
+        first[v] = first[v - 1];
+    }
+    first[0] = 0;
+
+    // timestamps start past the cache, so no vertex counts as cached before it is emitted
+    size_t now = (size_t)cache + 1, ndead = 0, emitted_num = 0;
+    vidx_t cursor = 0;
+    for (vidx_t f = triangles_nth(triangles, 0)[0]; f != VIDX_NONE;) {
+        // the vertices of the fan, the candidates for the next one, live on top of the dead-end stack
+        const size_t cands = ndead;
+        for (size_t j = first[f]; j < first[f + 1]; ++j) {
+            const vidx_t t = tris[j];
+            if (emitted[t]) continue;
+            emitted[t] = true;
+            order[emitted_num++] = t;
+            const vidx_t* tri = triangles_nth(triangles, t);
+            for (int k = 0; k < 3; ++k) {
+                const vidx_t v = tri[k];
+                dead[ndead++] = v;
+                live[v]--;
+                if (now - stamp[v] > (size_t)cache) {
+                    stamp[v] = now++;
+                }
+            }
+        }
+        f = tipsify_next(live, stamp, now, cache, ndead - cands, &dead[cands], &ndead, dead, &cursor, n);
+    }
+
+    ok = triangles_permute(triangles, 0, m, order);
+
+    if (ok && remap != NULL) {
+        // LIVE is all 0 again, now the new number + 1 of each old one
+        vidx_t next = 0;
+        for (size_t i = 0; i < 3 * (size_t)m; ++i) {
+            vidx_t* v = &triangles_nth(triangles, 0)[i];
+            if (live[*v] == 0) {
+                remap[next] = *v;
+                live[*v] = ++next;
+            }
+            *v = live[*v] - 1;
+        }
+        for (vidx_t v = 0; v < n; ++v) {
+            if (live[v] == 0) remap[next++] = v;
+        }
+    }
+    if (ok && acmr != NULL) acmr[1] = triangles_acmr(triangles, n, cache);
+
+cleanup:
+    free(emitted);
+    free(order);
+    free(dead);
+    free(stamp);
+    free(live);
+    free(tris);
+    free(first);
+    return ok;
+}
+
+MYIDEF void triangles_free(triangles_t triangles) {
+    if (triangles->adj_owned) {
+        free(triangles->adj);
+    }
+    free(triangles);
 }
 
 MYIDEF vertices_t vertices_attach(vidx_t n, const coord_t px[n], const coord_t py[n]) {
     vertices_t cs = (vertices_t) aligned_alloc(8, sizeof(*cs));
     cs->N = n;
+    cs->layout = VERTICES_SOA;
+    cs->x0 = cs->y0 = 0;
     cs->px = px;
     cs->py = py;
     return cs;
 }
 
+MYIDEF vertices_t vertices_attach_strided(vidx_t n, const void* base, size_t stride, size_t x_off, size_t y_off) {
+    vertices_t cs = (vertices_t) aligned_alloc(8, sizeof(*cs));
+    cs->N = n;
+    cs->layout = VERTICES_STRIDED;
+    cs->x0 = cs->y0 = 0;
+    cs->base = (const unsigned char*)base;
+    cs->stride = stride;
+    cs->xoff = x_off;
+    cs->yoff = y_off;
+    return cs;
+}
+
+// the plain layout when the source already is coord_t, so the vector loops still apply
+#define VERTICES_ATTACH_AS(n, x, y, other_layout) ({ \
+        vertices_t cs_ = (vertices_t) aligned_alloc(8, sizeof(*cs_)); \
+        cs_->N = (n); \
+        cs_->layout = _Generic((coord_t)0, __typeof__(*(x) + 0): VERTICES_SOA, default: (other_layout)); \
+        cs_->x0 = cs_->y0 = 0; \
+        cs_->px = (const coord_t*)(const void*)(x); \
+        cs_->py = (const coord_t*)(const void*)(y); \
+        cs_; })
+
+MYIDEF vertices_t vertices_attach_floats(vidx_t n, const float x[n], const float y[n]) {
+    return VERTICES_ATTACH_AS(n, x, y, VERTICES_FLOATS);
+}
+
+MYIDEF vertices_t vertices_attach_doubles(vidx_t n, const double x[n], const double y[n]) {
+    return VERTICES_ATTACH_AS(n, x, y, VERTICES_DOUBLES);
+}
+
+MYIDEF vertices_t vertices_attach_planar(vidx_t n, const coord_t px[n], const coord_t py[n], const coord_t pz[n], real_t normal[3]) {
+    real_t nx = 0, ny = 0, nz = 0;
+    for (vidx_t i = 0, j = n - 1; i < n; j = i++) {
+        nx += ((real_t)py[j] - py[i]) * ((real_t)pz[j] + pz[i]);
+        ny += ((real_t)pz[j] - pz[i]) * ((real_t)px[j] + px[i]);
+        nz += ((real_t)px[j] - px[i]) * ((real_t)py[j] + py[i]);
+    }
+    if (normal) {
+        normal[0] = nx;
+        normal[1] = ny;
+        normal[2] = nz;
+    }
+
+    // drop the dominant axis, the remaining two in cyclic order when it points up
+    const real_t ax = THE_ABS(nx), ay = THE_ABS(ny), az = THE_ABS(nz);
+    if (az >= ax && az >= ay) {
+        return nz >= 0 ? vertices_attach(n, px, py) : vertices_attach(n, py, px);
+    }
+    if (ax >= ay) {
+        return nx >= 0 ? vertices_attach(n, py, pz) : vertices_attach(n, pz, py);
+    }
+    return ny >= 0 ? vertices_attach(n, pz, px) : vertices_attach(n, px, pz);
+}
+
 MYIDEF vertices_t vertices_allocate(vidx_t n) {
     vertices_t cs = (vertices_t) aligned_alloc(8, sizeof(*cs) + n * (COORD_X_SZ + COORD_Y_SZ) );
     cs->N = n;
+    cs->layout = VERTICES_SOA;
+    cs->x0 = cs->y0 = 0;
     cs->px = cs->vertices;
     cs->py = cs->vertices + n;
     return cs;
 }
 
-MYIDEF vertices_t vertices_clone_doubles(vidx_t n, const double x[n], const double y[n]) {
-    vertices_t polygon = vertices_allocate(n);
-    for (__auto_type i=0; i<n; ++i) {
-        vertices_nth_setxy(polygon, i, (coord_t)x[i], (coord_t)y[i]);
+MYIDEF vertices_t vertices_quantize(vidx_t n, const coord_t px[n], const coord_t py[n]) {
+    vertices_t cs = (vertices_t) aligned_alloc(8, sizeof(*cs) + ((2 * n * sizeof(uint16_t) + 7) & ~(size_t)7));
+    cs->N = n;
+    cs->layout = VERTICES_QUANTIZED;
+    cs->qx = (const uint16_t*)cs->vertices;
+    cs->qy = cs->qx + n;
+
+    real_t minx = n > 0 ? px[0] : 0, maxx = minx;
+    real_t miny = n > 0 ? py[0] : 0, maxy = miny;
+    for (vidx_t i = 1; i < n; ++i) {
+        minx = THE_MIN(minx, px[i]);
+        maxx = THE_MAX(maxx, px[i]);
+        miny = THE_MIN(miny, py[i]);
+        maxy = THE_MAX(maxy, py[i]);
     }
-    return polygon;
-}
-
-MYIDEF vertices_t vertices_clone_floats(vidx_t n, const float x[n], const float y[n]) {
-    vertices_t polygon = vertices_allocate(n);
-    for (vidx_t i=0; i<n; ++i) {
-        vertices_nth_setxy(polygon, i, (coord_t)x[i], (coord_t)y[i]);
+    // one step for both axes keeps the orientations
+    real_t extent = THE_MAX(maxx - minx, maxy - miny);
+    cs->x0 = minx;
+    cs->y0 = miny;
+    cs->step = extent > 0 ? extent / VERTICES_QUANT_MAX : 1;
+
+    for (vidx_t i = 0; i < n; ++i) {
+        vertices_nth_setxy(cs, i, px[i], py[i]);
     }
-    return polygon;
+    return cs;
 }
 
-MYIDEF void vertices_destroy(vertices_t poly) {
-    free(poly);
-}
+// the offsets are taken in the source type, before rounding to coord_t
+#define VERTICES_CLONE(n, x, y) ({ \
+        vertices_t polygon_ = vertices_allocate(n); \
+        RECENTER_ORIGIN(n, x, y, polygon_->x0, polygon_->y0); \
+        for (vidx_t i_ = 0; i_ < (n); ++i_) { \
+            polygon_->vertices[i_] = COORD_ROUND((x)[i_] - polygon_->x0); \
+            polygon_->vertices[(n) + i_] = COORD_ROUND((y)[i_] - polygon_->y0); \
+        } \
+        polygon_; })
 
-MYIDEF vidx_t vertices_num(const vertices_t poly) {
-    return poly->n;
+MYIDEF vertices_t vertices_clone_doubles(vidx_t n, const double x[n], const double y[n]) {
+    return VERTICES_CLONE(n, x, y);
 }
 
-MYIDEF coord_t vertices_nth_getx(const vertices_t cs, vidx_t idx) {
-    return cs->px[idx];
+MYIDEF vertices_t vertices_clone_floats(vidx_t n, const float x[n], const float y[n]) {
+    return VERTICES_CLONE(n, x, y);
 }
 
-MYIDEF coord_t vertices_nth_gety(const vertices_t cs, vidx_t idx) {
-    return cs->py[idx];
+MYIDEF vertices_t vertices_clone_int32s(vidx_t n, const int32_t x[n], const int32_t y[n]) {
+    return VERTICES_CLONE(n, x, y);
 }
 
-MYIDEF void vertices_nth_setxy(vertices_t cs, vidx_t idx, coord_t x, coord_t y) {
-    cs->vertices[idx] = x;
-    cs->vertices[cs->n + idx] = y;
+MYIDEF void vertices_destroy(vertices_t poly) {
+    free(poly);
 }
 
+// the local coordinates in the ring kernels below
+#define VX(i) vertices_nth_localx(cs, (i))
+#define VY(i) vertices_nth_localy(cs, (i))
+
 MYIDEF holes_t holes_create_int16(int16_t num, const int16_t holeIndices[num]) {
 //MYIDEF holes_t holes_create(vidx_t num, vidx_t holeIndices[num]) {
     holes_t holes = (__typeof__(holes)) aligned_alloc(8, sizeof(*holes) + num * sizeof(holes->holeIndices[0]));
@@ -259,6 +1115,18 @@ MYIDEF holes_t holes_create_int32(int32_t num, const int32_t holeIndices[num]) {
     for (vidx_t i = 0; i < num; ++i) holes->holeIndices[i] = holeIndices[i];
     return holes;
 }
+MYIDEF holes_t holes_create_uint16(uint16_t num, const uint16_t holeIndices[num]) {
+    holes_t holes = (__typeof__(holes)) aligned_alloc(8, sizeof(*holes) + num * sizeof(holes->holeIndices[0]));
+    holes->num = num;
+    for (vidx_t i = 0; i < num; ++i) holes->holeIndices[i] = holeIndices[i];
+    return holes;
+}
+MYIDEF holes_t holes_create_int64(int64_t num, const int64_t holeIndices[num]) {
+    holes_t holes = (__typeof__(holes)) aligned_alloc(8, sizeof(*holes) + num * sizeof(holes->holeIndices[0]));
+    holes->num = num;
+    for (vidx_t i = 0; i < num; ++i) holes->holeIndices[i] = holeIndices[i];
+    return holes;
+}
 
 MYIDEF void holes_destory(holes_t holes) {
     free(holes);
@@ -287,49 +1155,128 @@ MYIDEF vidx_t holes_num(holes_t holes) {
     Input, double X[N], Y[N], the vertex coordinates.
     Output, double POLYGON_AREA, the area of the polygon.
 */
-MYIDEF coord_t signed_area(const vertices_t cs, vidx_t start, vidx_t end)
+MYIDEF area_t signed_area(const vertices_t cs, vidx_t start, vidx_t end)
 {
-    coord_t area = (__typeof__(area))0;
-    for (vidx_t i = start, j = end - 1; i < end; i++ ) {
-        __auto_type x_j = vertices_nth_getx(cs, j);
-        __auto_type y_j = vertices_nth_gety(cs, j);
-        __auto_type x_i = vertices_nth_getx(cs, i);
-        __auto_type y_i = vertices_nth_gety(cs, i);
-        area += (x_j - x_i) * (y_i + y_j);
-//        area += x_j * y_i - x_i * y_j;
-        j = i;
+    if (end - start < 2) {
+        return (area_t)0;
+    }
+    // X_J, Y_J is the vertex before X_I, Y_I, compensated
+    area_t sum = 0, comp = 0, vpart = 0;
+
+    KAHAN_ADD(sum, comp, ((area_t)VX(end - 1) - VX(start)) * ((area_t)VY(start) + VY(end - 1)));
+    vidx_t i = start + 1;
+    // the vector kernel reads the plain arrays, other layouts take the scalar loop
+    if (cs->layout == VERTICES_SOA) {
+        vpart = geom_kernels()->ring_area(cs->px, cs->py, &i, end);
+    }
+    for (; i < end; i++ ) {
+        KAHAN_ADD(sum, comp, ((area_t)VX(i - 1) - VX(i)) * ((area_t)VY(i) + VY(i - 1)));
     }
     //area = 0.5 * area; // it doesn't mater
 
-    return area;
+    return (sum - comp) + vpart;
 }
 
 /**
-  Purpose:
-    TRIANGLE_AREA computes the signed area of a triangle.
-    The signed area of a triangle is just the area of a triangle, if the vertices are listed counterclockwise,
-    or negative of that area, if the vertices are listed clockwise.
-
-  Modified:
-    05 May 2014
+ * signed_area() of every ring, one call per ring, slicing the rings out of HOLES:
+ * AREAS[0] is the outer ring, AREAS[1 + I] the I-th hole; HOLES may be NULL.
+ */
+MYIDEF void signed_areas(const vertices_t cs, const holes_t holes, area_t areas[])
+{
+    vidx_t rings = holes != NULL ? holes->num + 1 : 1;
+    for (vidx_t r = 0; r < rings; ++r) {
+        vidx_t start = r == 0 ? 0 : holes->holeIndices[r - 1];
+        vidx_t end = r < rings - 1 ? holes->holeIndices[r] : cs->n;
+        areas[r] = signed_area(cs, start, end);
+    }
+}
 
-  Author:
-    John Burkardt
+#ifndef USING_INT32_COORD
+// the expansions are exact only when every operation rounds on its own, none fused into an FMA
+#ifdef __clang__
+#define EXPANSION_NO_CONTRACT _Pragma("STDC FP_CONTRACT OFF")
+#else
+#define EXPANSION_NO_CONTRACT
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
 
-  Parameters:
-    Input, double XA, YA, XB, YB, XC, YC, the coordinates of
-    the vertices of the triangle, given in counterclockwise order.
+// x + y == a + b exactly
+#define TWO_SUM(a, b, x, y) do { (x) = (a) + (b); area_t bv_ = (x) - (a); area_t av_ = (x) - bv_; \
+        (y) = ((a) - av_) + ((b) - bv_); } while (0)
+// x + y == a - b exactly
+#define TWO_DIFF(a, b, x, y) do { (x) = (a) - (b); area_t bv_ = (a) - (x); area_t av_ = (x) + bv_; \
+        (y) = ((a) - av_) + (bv_ - (b)); } while (0)
+// hi + lo == a, each with half the significand
+#define SPLIT(a, hi, lo) do { area_t c_ = PRED_SPLITTER * (a); area_t big_ = c_ - (a); \
+        (hi) = c_ - big_; (lo) = (a) - (hi); } while (0)
+// x + y == a * b exactly
+#define TWO_PRODUCT(a, b, x, y) do { (x) = (a) * (b); area_t ahi_, alo_, bhi_, blo_; \
+        SPLIT(a, ahi_, alo_); SPLIT(b, bhi_, blo_); \
+        area_t err_ = (x) - ahi_ * bhi_; err_ -= alo_ * bhi_; err_ -= ahi_ * blo_; \
+        (y) = alo_ * blo_ - err_; } while (0)
+
+// adds q to the nonoverlapping expansion e[0..len), dropping zero components
+static int grow_expansion_zeroelim(int len, area_t e[], area_t q)
+{
+    EXPANSION_NO_CONTRACT
+    int out = 0;
+    for (int i = 0; i < len; ++i) {
+        area_t sum, err;
+        TWO_SUM(q, e[i], sum, err);
+        q = sum;
+        if (err != 0) {
+            e[out++] = err;
+        }
+    }
+    if (q != 0 || out == 0) {
+        e[out++] = q;
+    }
+    return out;
+}
 
-    Output, double TRIANGLE_AREA, the signed area of the triangle.
-*/
-MYIDEF coord_t triangle_area(const coord_t ax, const coord_t ay, const coord_t bx, const coord_t by, const coord_t cx, const coord_t cy)
+MYIDEF area_t orient2d_exact(const area_t ax, const area_t ay, const area_t bx, const area_t by, const area_t cx, const area_t cy)
 {
-    return /*0.5 * */( 
-          ( bx - ax ) * ( cy - ay ) 
-        - ( cx - ax ) * ( by - ay ) );
+    EXPANSION_NO_CONTRACT
+    area_t acx[2], acy[2], bcx[2], bcy[2];
+    TWO_DIFF(ax, cx, acx[0], acx[1]);
+    TWO_DIFF(ay, cy, acy[0], acy[1]);
+    TWO_DIFF(bx, cx, bcx[0], bcx[1]);
+    TWO_DIFF(by, cy, bcy[0], bcy[1]);
+
+    // (acx + acxtail) * (bcy + bcytail) - (acy + acytail) * (bcx + bcxtail), term by term
+    area_t e[16];
+    int len = 0;
+    for (int i = 0; i < 2; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            area_t hi, lo;
+            TWO_PRODUCT(acx[i], bcy[j], hi, lo);
+            len = grow_expansion_zeroelim(len, e, lo);
+            len = grow_expansion_zeroelim(len, e, hi);
+            TWO_PRODUCT(acy[i], bcx[j], hi, lo);
+            len = grow_expansion_zeroelim(len, e, -lo);
+            len = grow_expansion_zeroelim(len, e, -hi);
+        }
+    }
+
+    // the largest component carries the sign, the rest only refine the magnitude
+    area_t det = 0;
+    for (int i = 0; i < len; ++i) {
+        det += e[i];
+    }
+    if ((det > 0) - (det < 0) != (e[len - 1] > 0) - (e[len - 1] < 0)) {
+        det = e[len - 1];
+    }
+    return det;
 }
 
-#define THE_ATAN2(y,x) _Generic((y), float:atan2f(y,x), double:atan2(y,x))
+#ifndef __clang__
+#pragma GCC pop_options
+#endif
+#undef EXPANSION_NO_CONTRACT
+#endif // USING_INT32_COORD
+
+#define THE_ATAN2(y,x) _Generic((y), float:atan2f(y,x), default:atan2(y,x))
 
 /**
   Purpose:
@@ -358,11 +1305,11 @@ MYIDEF coord_t triangle_area(const coord_t ax, const coord_t ay, const coord_t b
     then VALUE is set to 0.
 */
 #define r8_pi 3.141592653589793
-MYIDEF coord_t angle_degree(const coord_t x1, const coord_t y1, const coord_t x2, const coord_t y2, const coord_t x3, const coord_t y3 )
+MYIDEF real_t angle_degree(const coord_t x1, const coord_t y1, const coord_t x2, const coord_t y2, const coord_t x3, const coord_t y3 )
 {
 
-    __auto_type x = ( x3 - x2 ) * ( x1 - x2 ) + ( y3 - y2 ) * ( y1 - y2 );
-    __auto_type y = ( x3 - x2 ) * ( y1 - y2 ) - ( y3 - y2 ) * ( x1 - x2 );
+    __auto_type x = (real_t)( (area_t)( x3 - x2 ) * ( x1 - x2 ) + (area_t)( y3 - y2 ) * ( y1 - y2 ) );
+    __auto_type y = (real_t)( (area_t)( x3 - x2 ) * ( y1 - y2 ) - (area_t)( y3 - y2 ) * ( x1 - x2 ) );
 
     if ( x == 0.0 && y == 0.0 ) {
         return 0.0;
@@ -376,6 +1323,69 @@ MYIDEF coord_t angle_degree(const coord_t x1, const coord_t y1, const coord_t x2
     }
 }
 
+// tan(ANGLE_TOL_DEGREE): the angle at P2 is too sharp iff 0 <= cross <= ANGLE_TOL_TAN * dot
+#define ANGLE_TOL_TAN 9.94837673637096e-07
+
+/**
+ * the checks of vertex P2 between its neighbours P1 and P3; the angle test gives the same
+ * outcome as ANGLE_DEGREE(P1, P2, P3) <= ANGLE_TOL_DEGREE without the atan2
+ */
+static int vertex_validate(const coord_t x1, const coord_t y1, const coord_t x2, const coord_t y2, const coord_t x3, const coord_t y3)
+{
+    if ( ( x1 == x2 && y1 == y2 ) || ( x3 == x2 && y3 == y2 ) ) {
+        return VERTICES_DUPLICATE;
+    }
+    __auto_type dot   = ( (area_t)x3 - x2 ) * ( (area_t)x1 - x2 ) + ( (area_t)y3 - y2 ) * ( (area_t)y1 - y2 );
+    __auto_type cross = ( (area_t)x3 - x2 ) * ( (area_t)y1 - y2 ) - ( (area_t)y3 - y2 ) * ( (area_t)x1 - x2 );
+    if ( ( dot == 0 && cross == 0 ) || ( dot > 0 && cross >= 0 && cross <= (real_t)ANGLE_TOL_TAN * dot ) ) {
+        return VERTICES_SHARP_ANGLE;
+    }
+    return VERTICES_VALID;
+}
+
+/**
+ * validate the ring [START, END) in a single pass: consecutive duplicates, sharp angles
+ * and the (doubled) signed area, which is stored to AREA only if the ring is valid.
+ * On failure the offending vertex is stored to AT. AREA and AT may be NULL; without AREA
+ * the scalar loop sums nothing, the vector kernel's sum rides on loads it makes anyway.
+ */
+MYIDEF int vertices_validate(const vertices_t cs, vidx_t start, vidx_t end, area_t* area, vidx_t* at)
+{
+    if (end - start < 3) {
+        if (at) *at = start;
+        return VERTICES_TOO_FEW;
+    }
+    area_t sum = 0, comp = 0, vpart = 0;
+
+    vidx_t i = start + 1;
+    int res = vertex_validate(VX(end - 1), VY(end - 1), VX(start), VY(start), VX(start + 1), VY(start + 1));
+    if (res != VERTICES_VALID) {
+        if (at) *at = start;
+        return res;
+    }
+    if (area) KAHAN_ADD(sum, comp, ((area_t)VX(end - 1) - VX(start)) * ((area_t)VY(start) + VY(end - 1)));
+
+    // the vector kernel stops in front of an offending vertex, the scalar loop below locates it
+    if (cs->layout == VERTICES_SOA) {
+        vpart = geom_kernels()->ring_validate(cs->px, cs->py, &i, end);
+    }
+
+    for (; i < end; ++i) {
+        vidx_t next = i + 1 < end ? i + 1 : start;
+        res = vertex_validate(VX(i - 1), VY(i - 1), VX(i), VY(i), VX(next), VY(next));
+        if (res != VERTICES_VALID) {
+            if (at) *at = i;
+            return res;
+        }
+        if (area) KAHAN_ADD(sum, comp, ((area_t)VX(i - 1) - VX(i)) * ((area_t)VY(i) + VY(i - 1)));
+    }
+
+    if (area) *area = (sum - comp) + vpart;
+    return VERTICES_VALID;
+}
+#undef VX
+#undef VY
+
 /**
   Purpose:
     COLLINEAR returns a measure of collinearity for three points.
@@ -411,24 +1421,34 @@ MYIDEF coord_t angle_degree(const coord_t x1, const coord_t y1, const coord_t x2
     Output, int COLLINEAR, is TRUE if the points are judged 
     to be collinear.
 */
+#define SQUARE(v) ({ __auto_type s_ = (v); s_ * s_; })
+
+#ifdef USING_INT32_COORD
+// the integer determinant is exact, no tolerance
+static bool collinear(const coord_t ax, const coord_t ay, const coord_t bx, const coord_t by, const coord_t cx, const coord_t cy)
+{
+    return triangle_area(ax, ay, bx, by, cx, cy) == 0;
+}
+#else
+// the relative tolerance of the double original, whatever area_t is; a coarser one
+// would take points that are merely close, not collinear, for collinear
 #define r8_eps 2.220446049250313E-016
 static bool collinear(const coord_t ax, const coord_t ay, const coord_t bx, const coord_t by, const coord_t cx, const coord_t cy)
 {
-    __auto_type side_ab_sq = (ax - bx) * (ax - bx) + (ay - by) * (ay - by);
-    __auto_type side_bc_sq = (bx - cx) * (bx - cx) + (by - cy) * (by - cy);
-    __auto_type side_ca_sq = (cx - ax) * (cx - ax) + (cy - ay) * (cy - ay);
+    __auto_type side_ab_sq = SQUARE((area_t)ax - bx) + SQUARE((area_t)ay - by);
+    __auto_type side_bc_sq = SQUARE((area_t)bx - cx) + SQUARE((area_t)by - cy);
+    __auto_type side_ca_sq = SQUARE((area_t)cx - ax) + SQUARE((area_t)cy - ay);
 
     __auto_type side_max_sq = THE_MAX(side_ab_sq, THE_MAX(side_bc_sq, side_ca_sq));
 
-    if ( side_max_sq <= r8_eps ) {
-        return true;
-    }
-    else if ( 2.0 * THE_ABS(triangle_area(ax, ay, bx, by, cx, cy)) <= r8_eps * side_max_sq) {
+    // scale free, three points close together aren't collinear for that alone
+    if ( 2.0 * THE_ABS(triangle_area(ax, ay, bx, by, cx, cy)) <= r8_eps * side_max_sq) {
         return true;
     }
 
     return false;
 }
+#endif // USING_INT32_COORD
 
 /**
   Purpose:
@@ -608,5 +1628,107 @@ MYIDEF bool intersects(const coord_t ax, const coord_t ay, const coord_t bx, con
     }
 }
 
+/**
+ * Every lane evaluates the four triangle areas and the four collinearity measures of
+ * intersect_prop(). A lane whose measures fall anywhere near the collinear() threshold
+ * takes the scalar intersects() path, the others are decided by the signs alone, which
+ * is what intersects() returns for points that are not collinear.
+ */
+MYIDEF bool intersects_any(const coord_t ax, const coord_t ay, const coord_t bx, const coord_t by, vidx_t m,
+                           const coord_t xc[m], const coord_t yc[m], const coord_t xd[m], const coord_t yd[m])
+{
+    return geom_kernels()->intersects_any(ax, ay, bx, by, m, xc, yc, xd, yd);
+}
+
+// the vector kernels, once per level; the baseline at the width the compiler flags allow
+#define KERNEL(name) name##_baseline
+#define KERNEL_TARGET
+#define KERNEL_VEC_BYTES COORD_VEC_BYTES
+#include "geometry_kernels.h"
+#undef KERNEL
+#undef KERNEL_TARGET
+#undef KERNEL_VEC_BYTES
+
+#if GEOMETRY_SIMD_X86
+#define KERNEL(name) name##_avx2
+#define KERNEL_TARGET __attribute__((target("avx2")))
+#define KERNEL_VEC_BYTES 32
+#include "geometry_kernels.h"
+#undef KERNEL
+#undef KERNEL_TARGET
+#undef KERNEL_VEC_BYTES
+
+#define KERNEL(name) name##_avx512
+#define KERNEL_TARGET __attribute__((target("avx512f,avx512vl")))
+#define KERNEL_VEC_BYTES 64
+#include "geometry_kernels.h"
+#undef KERNEL
+#undef KERNEL_TARGET
+#undef KERNEL_VEC_BYTES
+#endif
+
+// indexed by level
+static const struct geom_kernels_s geom_kernel_levels[] = {
+    { GEOMETRY_SIMD_BASELINE, ring_area_baseline, ring_validate_baseline, intersects_any_baseline },
+#if GEOMETRY_SIMD_X86
+    { GEOMETRY_SIMD_AVX2, ring_area_avx2, ring_validate_avx2, intersects_any_avx2 },
+    { GEOMETRY_SIMD_AVX512, ring_area_avx512, ring_validate_avx512, intersects_any_avx512 },
+#endif
+};
+
+static const struct geom_kernels_s* geom_kernels_bound = NULL;
+
+// CPUID, through the compiler's cpu model, which also checks the OS saves the wider registers
+static int geometry_simd_supported(void) {
+#if GEOMETRY_SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl")) {
+        return GEOMETRY_SIMD_AVX512;
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return GEOMETRY_SIMD_AVX2;
+    }
+#endif
+    return GEOMETRY_SIMD_BASELINE;
+}
+
+// POLY2TRI_SIMD=baseline|avx2|avx512, anything else means no override
+static int geometry_simd_from_env(void) {
+    const char* env = getenv("POLY2TRI_SIMD");
+    if (env == NULL) return GEOMETRY_SIMD_AUTO;
+    if (strcmp(env, "baseline") == 0) return GEOMETRY_SIMD_BASELINE;
+    if (strcmp(env, "avx2") == 0) return GEOMETRY_SIMD_AVX2;
+    if (strcmp(env, "avx512") == 0) return GEOMETRY_SIMD_AVX512;
+    return GEOMETRY_SIMD_AUTO;
+}
+
+MYIDEF int geometry_simd_set_level(int level) {
+    const int supported = geometry_simd_supported();
+    if (level == GEOMETRY_SIMD_AUTO) {
+        level = geometry_simd_from_env();
+    }
+    if (level == GEOMETRY_SIMD_AUTO || level > supported) {
+        level = supported;
+    }
+    if (level < GEOMETRY_SIMD_BASELINE) {
+        level = GEOMETRY_SIMD_BASELINE;
+    }
+    // concurrent first uses bind the same table
+    __atomic_store_n(&geom_kernels_bound, &geom_kernel_levels[level], __ATOMIC_RELEASE);
+    return level;
+}
+
+MYIDEF int geometry_simd_get_level(void) {
+    return geom_kernels()->level;
+}
+
+static const struct geom_kernels_s* geom_kernels(void) {
+    const struct geom_kernels_s* kernels = __atomic_load_n(&geom_kernels_bound, __ATOMIC_ACQUIRE);
+    if (__builtin_expect(kernels == NULL, 0)) {
+        geometry_simd_set_level(GEOMETRY_SIMD_AUTO);
+        kernels = __atomic_load_n(&geom_kernels_bound, __ATOMIC_ACQUIRE);
+    }
+    return kernels;
+}
 
 #endif // GEOM_TYPE_IMPLEMENTATION
@@ -0,0 +1,97 @@
+/**
+ * Several instantiations of coord_t and vidx_t in one binary.
+ *
+ * Each instantiation is a translation unit of its own, built with its USING_* flags and a
+ * POLY2TRI_PREFIX, see poly2tri_prefix.h. The code picking among them includes no other
+ * poly2tri header, it declares each instantiation by its prefix and types instead:
+ *
+ *   POLY2TRI_DECLARE_INSTANCE(p2t_f32i16_, float, float, float, int16_t)
+ *   POLY2TRI_DECLARE_INSTANCE(p2t_f64i32_, double, double, double, int32_t)
+ *
+ * COORD, AREA, REAL and VIDX must be what coord_t, area_t, real_t and vidx_t are under that
+ * instantiation's flags. The types come out prefixed as well, p2t_f32i16_vertices_t and so on.
+ * Every symbol poly2tri_prefix.h renames is declared; orient2d_exact() isn't defined by an
+ * int32 coordinate instantiation.
+ */
+#ifndef POLY2TRI_INSTANCE_H
+#define POLY2TRI_INSTANCE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define POLY2TRI_DECLARE_INSTANCE(P, COORD, AREA, REAL, VIDX) \
+    typedef struct P##vertices_s* P##vertices_t; \
+    typedef struct P##holes_s* P##holes_t; \
+    typedef struct P##triangles_s* P##triangles_t; \
+    typedef struct P##polygon_s* P##polygon_t; \
+    \
+    P##vertices_t P##vertices_allocate(VIDX n); \
+    P##vertices_t P##vertices_attach(VIDX n, const COORD px[], const COORD py[]); \
+    P##vertices_t P##vertices_attach_strided(VIDX n, const void* base, size_t stride, size_t x_off, size_t y_off); \
+    P##vertices_t P##vertices_attach_planar(VIDX n, const COORD px[], const COORD py[], const COORD pz[], REAL normal[3]); \
+    P##vertices_t P##vertices_quantize(VIDX n, const COORD px[], const COORD py[]); \
+    P##vertices_t P##vertices_attach_floats(VIDX n, const float x[], const float y[]); \
+    P##vertices_t P##vertices_attach_doubles(VIDX n, const double x[], const double y[]); \
+    P##vertices_t P##vertices_clone_floats(VIDX n, const float x[], const float y[]); \
+    P##vertices_t P##vertices_clone_doubles(VIDX n, const double x[], const double y[]); \
+    P##vertices_t P##vertices_clone_int32s(VIDX n, const int32_t x[], const int32_t y[]); \
+    void          P##vertices_destroy(P##vertices_t poly); \
+    VIDX          P##vertices_num(const P##vertices_t poly); \
+    COORD         P##vertices_nth_getx(const P##vertices_t cs, VIDX idx); \
+    COORD         P##vertices_nth_gety(const P##vertices_t cs, VIDX idx); \
+    void          P##vertices_nth_setxy(P##vertices_t cs, VIDX idx, COORD x, COORD y); \
+    COORD         P##vertices_nth_localx(const P##vertices_t cs, VIDX idx); \
+    COORD         P##vertices_nth_localy(const P##vertices_t cs, VIDX idx); \
+    int           P##vertices_validate(const P##vertices_t cs, VIDX start, VIDX end, AREA* area, VIDX* at); \
+    \
+    P##holes_t    P##holes_create_int16(int16_t num, const int16_t holeIndices[]); \
+    P##holes_t    P##holes_create_int32(int32_t num, const int32_t holeIndices[]); \
+    P##holes_t    P##holes_create_uint16(uint16_t num, const uint16_t holeIndices[]); \
+    P##holes_t    P##holes_create_int64(int64_t num, const int64_t holeIndices[]); \
+    void          P##holes_destory(P##holes_t holes); \
+    VIDX          P##holes_num(P##holes_t holes); \
+    \
+    P##polygon_t  P##polygon_build(const P##vertices_t vertices, const P##holes_t holes); \
+    void          P##polygon_destroy(P##polygon_t polygon); \
+    AREA          P##polygon_area(P##polygon_t polygon); \
+    P##vertices_t P##polygon_getvertices(P##polygon_t polygon); \
+    \
+    P##triangles_t P##triangles_allocate(VIDX m); \
+    P##triangles_t P##triangles_attach(VIDX capacity, VIDX buffer[]); \
+    typedef void (*P##triangles_sink_t)(void* ctx, VIDX first, VIDX num, const VIDX tri[]); \
+    P##triangles_t P##triangles_stream(VIDX batch, P##triangles_sink_t sink, void* ctx); \
+    void          P##triangles_flush(P##triangles_t triangles); \
+    bool          P##triangles_adjacency(P##triangles_t triangles, VIDX num, VIDX adj[]); \
+    VIDX*         P##triangles_nth_adjacent(P##triangles_t triangles, VIDX i); \
+    size_t        P##triangles_strip(P##triangles_t triangles, size_t num, VIDX strip[]); \
+    double        P##triangles_acmr(P##triangles_t triangles, VIDX n, VIDX cache); \
+    bool          P##triangles_optimize(P##triangles_t triangles, VIDX n, VIDX cache, VIDX remap[], double acmr[2]); \
+    VIDX          P##triangles_num(P##triangles_t triangles); \
+    VIDX          P##triangles_append(P##triangles_t triangles, VIDX a, VIDX b, VIDX c); \
+    VIDX*         P##triangles_nth(P##triangles_t triangles, VIDX i); \
+    void          P##triangles_free(P##triangles_t triangles); \
+    \
+    AREA          P##signed_area(const P##vertices_t cs, VIDX start, VIDX end); \
+    void          P##signed_areas(const P##vertices_t cs, const P##holes_t holes, AREA areas[]); \
+    AREA          P##triangle_area(COORD xa, COORD ya, COORD xb, COORD yb, COORD xc, COORD yc); \
+    AREA          P##orient2d(COORD ax, COORD ay, COORD bx, COORD by, COORD cx, COORD cy); \
+    AREA          P##orient2d_exact(AREA ax, AREA ay, AREA bx, AREA by, AREA cx, AREA cy); \
+    REAL          P##angle_degree(COORD x1, COORD y1, COORD x2, COORD y2, COORD x3, COORD y3); \
+    bool          P##between(COORD xa, COORD ya, COORD xb, COORD yb, COORD xc, COORD yc); \
+    bool          P##intersects(COORD xa, COORD ya, COORD xb, COORD yb, COORD xc, COORD yc, COORD xd, COORD yd); \
+    bool          P##intersects_any(COORD xa, COORD ya, COORD xb, COORD yb, VIDX m, \
+                                    const COORD xc[], const COORD yc[], const COORD xd[], const COORD yd[]); \
+    int           P##geometry_simd_set_level(int level); \
+    int           P##geometry_simd_get_level(void); \
+    \
+    P##triangles_t P##polygon_earcut(const P##vertices_t vertices, const P##holes_t holes); \
+    P##triangles_t P##polygon_earcut_ex(const P##vertices_t vertices, const P##holes_t holes, unsigned flags); \
+    bool          P##polygon_earcut_to(const P##vertices_t vertices, const P##holes_t holes, unsigned flags, P##triangles_t triangles); \
+    P##triangles_t P##polygon_triangulate(const P##vertices_t cs); \
+    P##triangles_t P##polygon_triangulate_ex(const P##vertices_t cs, unsigned flags, AREA area); \
+    bool          P##polygon_triangulate_to(const P##vertices_t cs, unsigned flags, AREA area, P##triangles_t triangles); \
+    size_t        P##polygon_triangulate_workspace_size(VIDX n); \
+    VIDX          P##polygon_triangulate_work(const P##vertices_t cs, unsigned flags, AREA area, void* work, VIDX triangles[]);
+
+#endif // POLY2TRI_INSTANCE_H
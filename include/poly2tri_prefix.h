@@ -0,0 +1,91 @@
+/**
+ * Symbol prefixes for linking several instantiations into one binary, see poly2tri_instance.h.
+ *
+ * Included by geometry_type.h when POLY2TRI_PREFIX names the prefix, e.g.
+ *
+ *   #define POLY2TRI_PREFIX p2t_f32i16_
+ *   #define USING_INT16_INDEX
+ *   #define POLY2TRI_IMPLEMENTATION
+ *   #include "polygon_earcut.h"
+ *   #include "polygon_triangulate.h"
+ *
+ * then defines p2t_f32i16_polygon_earcut() and the rest under that prefix. Every symbol
+ * with external linkage is renamed, so is every struct tag, which keeps the types of
+ * different instantiations apart. An instantiation can't be built POLY2TRI_STATIC_INLINE,
+ * the accessors wouldn't be there to link against.
+ */
+#pragma once
+
+#ifdef POLY2TRI_STATIC_INLINE
+#error "POLY2TRI_PREFIX: the accessors of an instantiation must be extern"
+#endif
+
+#define P2T_CAT_(a, b) a##b
+#define P2T_CAT(a, b) P2T_CAT_(a, b)
+#define P2T_NAME(name) P2T_CAT(POLY2TRI_PREFIX, name)
+
+#define vertices_s                         P2T_NAME(vertices_s)
+#define holes_s                            P2T_NAME(holes_s)
+#define triangles_s                        P2T_NAME(triangles_s)
+#define polygon_s                          P2T_NAME(polygon_s)
+
+#define angle_degree                       P2T_NAME(angle_degree)
+#define between                            P2T_NAME(between)
+#define geometry_simd_get_level            P2T_NAME(geometry_simd_get_level)
+#define geometry_simd_set_level            P2T_NAME(geometry_simd_set_level)
+#define holes_create_int16                 P2T_NAME(holes_create_int16)
+#define holes_create_int32                 P2T_NAME(holes_create_int32)
+#define holes_create_int64                 P2T_NAME(holes_create_int64)
+#define holes_create_uint16                P2T_NAME(holes_create_uint16)
+#define holes_destory                      P2T_NAME(holes_destory)
+#define holes_num                          P2T_NAME(holes_num)
+#define intersects                         P2T_NAME(intersects)
+#define intersects_any                     P2T_NAME(intersects_any)
+#define orient2d                           P2T_NAME(orient2d)
+#define orient2d_exact                     P2T_NAME(orient2d_exact)
+#define polygon_area                       P2T_NAME(polygon_area)
+#define polygon_build                      P2T_NAME(polygon_build)
+#define polygon_destroy                    P2T_NAME(polygon_destroy)
+#define polygon_earcut                     P2T_NAME(polygon_earcut)
+#define polygon_earcut_ex                  P2T_NAME(polygon_earcut_ex)
+#define polygon_earcut_to                  P2T_NAME(polygon_earcut_to)
+#define polygon_getvertices                P2T_NAME(polygon_getvertices)
+#define polygon_triangulate                P2T_NAME(polygon_triangulate)
+#define polygon_triangulate_ex             P2T_NAME(polygon_triangulate_ex)
+#define polygon_triangulate_to             P2T_NAME(polygon_triangulate_to)
+#define polygon_triangulate_work           P2T_NAME(polygon_triangulate_work)
+#define polygon_triangulate_workspace_size P2T_NAME(polygon_triangulate_workspace_size)
+#define signed_area                        P2T_NAME(signed_area)
+#define signed_areas                       P2T_NAME(signed_areas)
+#define triangle_area                      P2T_NAME(triangle_area)
+#define triangles_acmr                     P2T_NAME(triangles_acmr)
+#define triangles_adjacency                P2T_NAME(triangles_adjacency)
+#define triangles_allocate                 P2T_NAME(triangles_allocate)
+#define triangles_attach                   P2T_NAME(triangles_attach)
+#define triangles_append                   P2T_NAME(triangles_append)
+#define triangles_flush                    P2T_NAME(triangles_flush)
+#define triangles_free                     P2T_NAME(triangles_free)
+#define triangles_nth                      P2T_NAME(triangles_nth)
+#define triangles_nth_adjacent             P2T_NAME(triangles_nth_adjacent)
+#define triangles_stream                   P2T_NAME(triangles_stream)
+#define triangles_strip                    P2T_NAME(triangles_strip)
+#define triangles_num                      P2T_NAME(triangles_num)
+#define triangles_optimize                 P2T_NAME(triangles_optimize)
+#define vertices_allocate                  P2T_NAME(vertices_allocate)
+#define vertices_attach                    P2T_NAME(vertices_attach)
+#define vertices_attach_doubles            P2T_NAME(vertices_attach_doubles)
+#define vertices_attach_floats             P2T_NAME(vertices_attach_floats)
+#define vertices_attach_planar             P2T_NAME(vertices_attach_planar)
+#define vertices_attach_strided            P2T_NAME(vertices_attach_strided)
+#define vertices_clone_doubles             P2T_NAME(vertices_clone_doubles)
+#define vertices_clone_floats              P2T_NAME(vertices_clone_floats)
+#define vertices_clone_int32s              P2T_NAME(vertices_clone_int32s)
+#define vertices_destroy                   P2T_NAME(vertices_destroy)
+#define vertices_nth_getx                  P2T_NAME(vertices_nth_getx)
+#define vertices_nth_gety                  P2T_NAME(vertices_nth_gety)
+#define vertices_nth_localx                P2T_NAME(vertices_nth_localx)
+#define vertices_nth_localy                P2T_NAME(vertices_nth_localy)
+#define vertices_nth_setxy                 P2T_NAME(vertices_nth_setxy)
+#define vertices_num                       P2T_NAME(vertices_num)
+#define vertices_quantize                  P2T_NAME(vertices_quantize)
+#define vertices_validate                  P2T_NAME(vertices_validate)
@@ -1,17 +1,47 @@
-#ifndef POLYGON_EARCUT_H
-#define POLYGON_EARCUT_H
-
+// outside the guard, so the implementation can follow the header in the same translation unit
 #ifdef POLY2TRI_IMPLEMENTATION
 #define GEOM_TYPE_IMPLEMENTATION
 #endif
 #include "geometry_type.h"
 
+#ifndef POLYGON_EARCUT_H
+#define POLYGON_EARCUT_H
+
 triangles_t polygon_earcut(const vertices_t vertices, const holes_t holes);
+triangles_t polygon_earcut_ex(const vertices_t vertices, const holes_t holes, unsigned flags);
+// appends to TRIANGLES, e.g. a triangles_attach() of the caller's memory, at most n-2 + 2*holes of them;
+// false when the polygon is rejected or doesn't fit, with triangles_num() as it was, though the
+// slots past it, up to the capacity, may have been written by then.
+// A triangles_stream() is flushed on return. Rejected after a batch went out, the sink has
+// already been handed triangles from the old triangles_num() up to the one it is left at;
+// those belong to the rejected polygon and are the caller's to discard.
+// In float builds far-out input is cut about the outer ring's bbox center, attached buffers
+// and views included.
+bool polygon_earcut_to(const vertices_t vertices, const holes_t holes, unsigned flags, triangles_t triangles);
 
 #endif // POLYGON_EARCUT_H
 
 #ifdef POLY2TRI_IMPLEMENTATION
 
+#include "mylog.h"
+
+#ifdef USING_INT32_COORD
+// z-order hash scale: right shift bringing the longer side of data bbox into 15 bits, -1 when unused
+typedef int zscale_t;
+#define ZSCALE_NONE (-1)
+#define ZSCALE_USED(invSize) ((invSize) >= 0)
+#define ZORDER_SCALE(v0, min, invSize) ((int32_t)((uint32_t)((v0) - (min)) >> (invSize)))
+// the largest integer not above a real coordinate
+#define COORD_FLOOR(v) ((coord_t)floor(v))
+#else
+// z-order hash scale: inverse of the longer side of data bbox, 0 when unused
+typedef coord_t zscale_t;
+#define ZSCALE_NONE 0
+#define ZSCALE_USED(invSize) ((invSize) != 0)
+#define ZORDER_SCALE(v0, min, invSize) ((int32_t)(32767 * ((v0) - (min)) * (invSize)))
+#define COORD_FLOOR(v) (v)
+#endif
+
 typedef struct node_t {
     vidx_t i;
     coord_t x;
@@ -22,9 +52,13 @@ typedef struct node_t {
     struct node_t* next;
     struct node_t* nextZ;
     struct node_t* prevZ;
+    // for the adjacency, of the edge to next: the half-edge across it once cut,
+    // or the node whose edge is the same bridge or split diagonal the other way round
+    size_t half;
+    struct node_t* twin;
 } node_t;
 
-node_t* allocate_node(vidx_t i, coord_t x, coord_t y) {
+static node_t* allocate_node(vidx_t i, coord_t x, coord_t y) {
     node_t* p = (node_t*)calloc(1, sizeof(*p));
     *p = (node_t) {
         .i = i,
@@ -32,16 +66,60 @@ node_t* allocate_node(vidx_t i, coord_t x, coord_t y) {
         .y = y,
         .z = -1,
         .steiner = false,
+        .half = HALF_NONE,
     };
     return p;
 }
 
+// P's edge goes away, so does the pairing with its twin
+static void untwin(node_t* p) {
+    if (p->twin != NULL) {
+        p->twin->twin = NULL;
+        p->twin = NULL;
+    }
+}
+
+// edge K of the new triangle T is the edge of X
+static void claimEdge(triangles_t triangles, vidx_t t, int k, node_t* x) {
+    triangles_link(triangles, t, k, x->half);
+    if (x->twin != NULL) {
+        // the other way round is yet to be cut, it links up then
+        x->twin->half = 3 * (size_t)t + k;
+        x->twin->twin = NULL;
+        x->twin = NULL;
+    }
+    x->half = HALF_NONE;
+}
+
 // check if two points are equal
-bool equals(node_t* p1, node_t* p2) {
+static bool equals(node_t* p1, node_t* p2) {
     return p1->x == p2->x && p1->y == p2->y;
 }
 
-node_t* insertNode(vidx_t i, coord_t x, coord_t y, node_t* last) {
+// P is about to be removed, the edge of P->prev then runs on to P->next; what either edge
+// knows carries over only to the same segment, a merged collinear one drops its links
+static void foldEdge(node_t* p) {
+    node_t* prev = p->prev;
+    if (equals(prev, p)) {
+        // the edge of PREV is empty, the one of P stays as is
+        untwin(prev);
+        prev->half = p->half;
+        prev->twin = p->twin;
+        if (p->twin != NULL) p->twin->twin = prev;
+        p->twin = NULL;
+    }
+    else if (equals(p, p->next)) {
+        // the edge of P is empty
+        untwin(p);
+    }
+    else {
+        untwin(prev);
+        untwin(p);
+        prev->half = HALF_NONE;
+    }
+}
+
+static node_t* insertNode(vidx_t i, coord_t x, coord_t y, node_t* last) {
     node_t* p = allocate_node(i, x, y);
 
     if (NULL == last) {
@@ -57,7 +135,7 @@ node_t* insertNode(vidx_t i, coord_t x, coord_t y, node_t* last) {
     return p;
 }
 
-void removeNode(node_t *p) {
+static void removeNode(node_t *p) {
     p->next->prev = p->prev;
     p->prev->next = p->next;
 
@@ -65,20 +143,22 @@ void removeNode(node_t *p) {
     if (p->nextZ != NULL) p->nextZ->prevZ = p->prevZ;
 }
 
-node_t* linkedList(const vertices_t vertices, vidx_t start, vidx_t end, bool counterclockwise) {
+// AREA is the signed area of the ring, as given by signed_areas(); the nodes are relative to (OX, OY)
+static node_t* linkedList(const vertices_t vertices, vidx_t start, vidx_t end, area_t area, bool counterclockwise, coord_t ox, coord_t oy) {
     node_t* last = NULL;
-    if (counterclockwise == (signed_area(vertices, start, end) > 0)) {
+    if (counterclockwise == (area > 0)) {
         for (vidx_t i = start; i < end; ++i) {
-            __auto_type xi = vertices_nth_getx(vertices, i);
-            __auto_type yi = vertices_nth_gety(vertices, i);
-            last = insertNode(i, xi, yi, last);
+            __auto_type xi = vertices_nth_localx(vertices, i);
+            __auto_type yi = vertices_nth_localy(vertices, i);
+            last = insertNode(i, xi - ox, yi - oy, last);
         }
     }
     else {
-        for (vidx_t i = end - 1; i >= start; --i) {
-            __auto_type xi = vertices_nth_getx(vertices, i);
-            __auto_type yi = vertices_nth_gety(vertices, i);
-            last = insertNode(i, xi, yi, last);
+        // counts down without going below start, vidx_t may be unsigned
+        for (vidx_t i = end; i-- > start; ) {
+            __auto_type xi = vertices_nth_localx(vertices, i);
+            __auto_type yi = vertices_nth_localy(vertices, i);
+            last = insertNode(i, xi - ox, yi - oy, last);
         }
     }
 
@@ -91,11 +171,11 @@ node_t* linkedList(const vertices_t vertices, vidx_t start, vidx_t end, bool cou
     return last;
 }
 
-// z-order of a point given coords and inverse of the longer side of data bbox
-coord_t zOrder(coord_t x0, coord_t y0, coord_t minX, coord_t minY, coord_t invSize) {
+// z-order of a point given coords and the scale of the data bbox, see zscale_t; 30 bits
+static int32_t zOrderKey(coord_t x0, coord_t y0, coord_t minX, coord_t minY, zscale_t invSize) {
     // coords are transformed into non-negative 15-bit integer range
-     int32_t x = (int32_t) (32767 * (x0 - minX) * invSize);
-     int32_t y = (int32_t) (32767 * (y0 - minY) * invSize);
+     int32_t x = ZORDER_SCALE(x0, minX, invSize);
+     int32_t y = ZORDER_SCALE(y0, minY, invSize);
 
      x = (x | (x << 8)) & 0x00FF00FF;
      x = (x | (x << 4)) & 0x0F0F0F0F;
@@ -110,11 +190,16 @@ coord_t zOrder(coord_t x0, coord_t y0, coord_t minX, coord_t minY, coord_t invSi
      return x | (y << 1);
 }
 
-node_t* sortLinked(node_t* list) {
+static coord_t zOrder(coord_t x0, coord_t y0, coord_t minX, coord_t minY, zscale_t invSize) {
+    return zOrderKey(x0, y0, minX, minY, invSize);
+}
+
+static node_t* sortLinked(node_t* list) {
     vidx_t i;
     vidx_t inSize = 1;
     node_t *p, *q, *e, *tail;
-    int numMerges, pSize, qSize;
+    // as wide as the node count, every one of them may reach it
+    vidx_t numMerges, pSize, qSize;
     if (!list) return NULL;
 
     do {
@@ -156,13 +241,15 @@ node_t* sortLinked(node_t* list) {
         }
 
         tail->nextZ = NULL;
-        inSize *= 2;
-    } while (numMerges > 1);
+        if (numMerges <= 1) break;
+        // a run that long already covers every node left
+        inSize = inSize > VIDX_MAX / 2 ? VIDX_MAX : 2 * inSize;
+    } while (true);
     return list;
 }
 
 // interlink polygon nodes in z-order
-void indexCurve(node_t* start, coord_t minX, coord_t minY, coord_t invSize) {
+static void indexCurve(node_t* start, coord_t minX, coord_t minY, zscale_t invSize) {
     node_t* p = start;
     do {
         if (p->z == -1) p->z = zOrder(p->x, p->y, minX, minY, invSize);
@@ -177,7 +264,7 @@ void indexCurve(node_t* start, coord_t minX, coord_t minY, coord_t invSize) {
     sortLinked(p);
 }
 
-int sign(coord_t num) {
+static int sign(area_t num) {
     return num > 0 ? 1 : num < 0 ? -1 : 0;
 }
 
@@ -187,17 +274,17 @@ int sign(coord_t num) {
  * clockwise: area > 0;
  * couter-clockwise: area < 0
  */
-float area(node_t *a, node_t *b, node_t *c) {
-    return (b->y - a->y) * (c->x - b->x) - (b->x - a->x) * (c->y - b->y);
+static area_t area(node_t *a, node_t *b, node_t *c) {
+    return -orient2d(a->x, a->y, b->x, b->y, c->x, c->y);
 }
 
 // for collinear points p, q, r, check if point q lies on segment pr
-bool onSegment(node_t *p, node_t* q, node_t* r) {
+static bool onSegment(node_t *p, node_t* q, node_t* r) {
     return q->x <= THE_MAX(p->x, r->x) && q->x >= THE_MIN(p->x, r->x) && q->y <= THE_MAX(p->y, r->y) && q->y >= THE_MIN(p->y, r->y);
 }
 
 // check if two segments intersect
-bool seg_intersects(node_t *p1, node_t *q1, node_t *p2, node_t *q2) {
+static bool seg_intersects(node_t *p1, node_t *q1, node_t *p2, node_t *q2) {
     int o1 = sign(area(p1, q1, p2));
     int o2 = sign(area(p1, q1, q2));
     int o3 = sign(area(p2, q2, p1));
@@ -214,7 +301,7 @@ bool seg_intersects(node_t *p1, node_t *q1, node_t *p2, node_t *q2) {
 }
 
 // check if a polygon diagonal intersects any polygon segments
-bool intersectsPolygon(node_t* a, node_t* b) {
+static bool intersectsPolygon(node_t* a, node_t* b) {
     node_t *p = a;
     do {
         if (p->i != a->i && p->next->i != a->i && p->i != b->i && p->next->i != b->i &&
@@ -228,25 +315,25 @@ bool intersectsPolygon(node_t* a, node_t* b) {
 /**
  * check if a point lies within a convex triangle
  */
-bool pointInTriangle(coord_t ax, coord_t ay, coord_t bx, coord_t by, coord_t cx, coord_t cy, coord_t px, coord_t py) {
-     return (cx - px) * (ay - py) - (ax - px) * (cy - py) >= 0 &&
-             (ax - px) * (by - py) - (bx - px) * (ay - py) >= 0 &&
-             (bx - px) * (cy - py) - (cx - px) * (by - py) >= 0;
+static bool pointInTriangle(coord_t ax, coord_t ay, coord_t bx, coord_t by, coord_t cx, coord_t cy, coord_t px, coord_t py) {
+     return orient2d(px, py, cx, cy, ax, ay) >= 0 &&
+             orient2d(px, py, ax, ay, bx, by) >= 0 &&
+             orient2d(px, py, bx, by, cx, cy) >= 0;
 }
 
 // check if a polygon diagonal is locally inside the polygon
-bool locallyInside(node_t *a, node_t *b) {
+static bool locallyInside(node_t *a, node_t *b) {
     return area(a->prev, a, a->next) < 0 ?
                 area(a, b, a->next) >= 0 && area(a, a->prev, b) >= 0 :
                 area(a, b, a->prev) < 0 || area(a, a->next, b) < 0;
 }
 
 // check if the middle point of a polygon diagonal is inside the polygon
-bool middleInside(node_t *a, node_t *b) {
+static bool middleInside(node_t *a, node_t *b) {
     node_t* p = a;
     bool inside = false;
-    coord_t px = (a->x + b->x) / 2,
-            py = (a->y + b->y) / 2;
+    real_t px = ((real_t)a->x + b->x) / 2,
+           py = ((real_t)a->y + b->y) / 2;
     do {
         if (((p->y > py) != (p->next->y > py)) && p->next->y != p->y &&
                 (px < (p->next->x - p->x) * (py - p->y) / (p->next->y - p->y) + p->x))
@@ -258,27 +345,27 @@ bool middleInside(node_t *a, node_t *b) {
 }
 
 // check if a diagonal between two polygon nodes is valid (lies in polygon interior)
-bool isValidDiagonal(node_t* a, node_t* b) {
+static bool isValidDiagonal(node_t* a, node_t* b) {
     return a->next->i != b->i && a->prev->i != b->i && !intersectsPolygon(a, b) &&  // dones't intersect other edges
         ((locallyInside(a, b) && locallyInside(b, a) && middleInside(a, b) &&        // locally visible
              (area(a->prev, a, b->prev) != 0 || area(a, b->prev, b) != 0)) ||        // does not create opposite-facing sectors
              (equals(a, b) && area(a->prev, a, a->next) > 0 && area(b->prev, b, b->next) > 0)); // special zero-length case
 }
 
-bool isEarHashed(node_t* ear, coord_t minX, coord_t minY, coord_t invSize) {
+static bool isEarHashed(node_t* ear, coord_t minX, coord_t minY, zscale_t invSize) {
     node_t *a = ear->prev,
            *b = ear,
            *c = ear->next;
     if (area(a, b, c) >= 0) return false; // reflex, can't be an ear
 
     // triangle bbox; min & max are calculated like this for speed
-     float minTX = a->x < b->x ? (a->x < c->x ? a->x : c->x) : (b->x < c->x ? b->x : c->x),
+     coord_t minTX = a->x < b->x ? (a->x < c->x ? a->x : c->x) : (b->x < c->x ? b->x : c->x),
            minTY = a->y < b->y ? (a->y < c->y ? a->y : c->y) : (b->y < c->y ? b->y : c->y),
            maxTX = a->x > b->x ? (a->x > c->x ? a->x : c->x) : (b->x > c->x ? b->x : c->x),
            maxTY = a->y > b->y ? (a->y > c->y ? a->y : c->y) : (b->y > c->y ? b->y : c->y);
 
     // z-order range for the current triangle bbox;
-    float minZ = zOrder(minTX, minTY, minX, minY, invSize),
+    coord_t minZ = zOrder(minTX, minTY, minX, minY, invSize),
           maxZ = zOrder(maxTX, maxTY, minX, minY, invSize);
 
     node_t *p = ear->prevZ,
@@ -320,7 +407,7 @@ bool isEarHashed(node_t* ear, coord_t minX, coord_t minY, coord_t invSize) {
     return true;
 }
 
-bool isEar(node_t* ear) {
+static bool isEar(node_t* ear) {
     node_t *a = ear->prev,
            *b = ear,
            *c = ear->next;
@@ -341,7 +428,7 @@ bool isEar(node_t* ear) {
 /**
  * eliminate colinear or duplicate points
  */
-node_t* filterPoints(node_t* start, node_t* end) {
+static node_t* filterPoints(node_t* start, node_t* end) {
     if (start == NULL) return NULL;
     if (end == NULL) end = start;
 
@@ -351,6 +438,7 @@ node_t* filterPoints(node_t* start, node_t* end) {
         again = false;
 
         if (!p->steiner && (equals(p, p->next) || area(p->prev, p, p->next) == 0)) {
+            foldEdge(p);
             removeNode(p);
             end = p->prev;
             free(p);
@@ -369,14 +457,23 @@ node_t* filterPoints(node_t* start, node_t* end) {
 /**
  * go through all polygon nodes and cure small local self-intersections
  */
-node_t* cureLocalIntersections(node_t* start, triangles_t triangles) {
+static node_t* cureLocalIntersections(node_t* start, triangles_t triangles) {
     node_t* p = start;
     do {
         node_t *a = p->prev,
                *b = p->next->next;
 
         if (!equals(a, b) && seg_intersects(a, p, p->next, b) && locallyInside(a, b) && locallyInside(b, a)) {
-            triangles_append(triangles, a->i, p->i, b->i);
+            vidx_t t = triangles_append(triangles, a->i, p->i, b->i) - 1;
+            if (triangles->adj != NULL) {
+                // P:B crosses the edges of P and P->next, which go away with them
+                claimEdge(triangles, t, 0, a);
+                triangles_link(triangles, t, 1, HALF_NONE);
+                triangles_link(triangles, t, 2, HALF_NONE);
+                a->half = 3 * (size_t)t + 2;
+            }
+            untwin(p);
+            untwin(p->next);
 
             // remove two nodes involved
             removeNode(p);
@@ -395,12 +492,20 @@ node_t* cureLocalIntersections(node_t* start, triangles_t triangles) {
 
 // link two polygon vertices with a bridge; if the vertices belong to the same ring, it splits polygon into two;
 // if one belongs to the outer ring and another to a hole, it merges it into a single ring
-node_t* splitPolygon(node_t* a, node_t* b) {
+static node_t* splitPolygon(node_t* a, node_t* b) {
     node_t *a2 = allocate_node(a->i, a->x, a->y),
            *b2 = allocate_node(b->i, b->x, b->y),
            *an = a->next,
            *bp = b->prev;
 
+    // A's edge moves on to A2, A:B and B2:A2 are the bridge both ways
+    a2->half = a->half;
+    a2->twin = a->twin;
+    if (a->twin != NULL) a->twin->twin = a2;
+    a->half = HALF_NONE;
+    a->twin = b2;
+    b2->twin = a;
+
     a->next = b;
     b->prev = a;
 
@@ -416,12 +521,12 @@ node_t* splitPolygon(node_t* a, node_t* b) {
     return b2;
 }
 
-void earcutLinked(node_t* ear, triangles_t triangles, coord_t minX, coord_t minY, coord_t invSize, int pass);
+static void earcutLinked(node_t* ear, triangles_t triangles, coord_t minX, coord_t minY, zscale_t invSize, int pass);
 
 /**
  * try splitting polygon into two and triangulate them independently
  */
-void splitEarcut(node_t* start, triangles_t triangles, coord_t minX, coord_t minY, coord_t invSize) {
+static void splitEarcut(node_t* start, triangles_t triangles, coord_t minX, coord_t minY, zscale_t invSize) {
     // look for a valid diagonal that divides the polygon into two
     node_t *a = start;
     do {
@@ -447,12 +552,12 @@ void splitEarcut(node_t* start, triangles_t triangles, coord_t minX, coord_t min
 }
 
 // main ear slicing loop which triangulates a polygon (given as a linked list)
-void earcutLinked(node_t* ear, triangles_t triangles, coord_t minX, coord_t minY, coord_t invSize, int pass) {
+static void earcutLinked(node_t* ear, triangles_t triangles, coord_t minX, coord_t minY, zscale_t invSize, int pass) {
 
     if (NULL == ear) return;
 
     // interlink polygon nodes in z-order
-    if (pass == 0 && invSize != 0) indexCurve(ear, minX, minY, invSize);
+    if (pass == 0 && ZSCALE_USED(invSize)) indexCurve(ear, minX, minY, invSize);
 
     node_t *stop = ear;
     node_t *prev, *next;
@@ -461,9 +566,16 @@ void earcutLinked(node_t* ear, triangles_t triangles, coord_t minX, coord_t minY
         prev = ear->prev;
         next = ear->next;
 
-        if (invSize != 0 ? isEarHashed(ear, minX, minY, invSize) : isEar(ear)) {
+        if (ZSCALE_USED(invSize) ? isEarHashed(ear, minX, minY, invSize) : isEar(ear)) {
             // cut off the triangle
-            triangles_append(triangles, prev->i, ear->i, next->i);
+            vidx_t t = triangles_append(triangles, prev->i, ear->i, next->i) - 1;
+            if (triangles->adj != NULL) {
+                // NEXT:PREV is new, the edge of PREV from now on
+                claimEdge(triangles, t, 0, prev);
+                claimEdge(triangles, t, 1, ear);
+                triangles_link(triangles, t, 2, HALF_NONE);
+                prev->half = 3 * (size_t)t + 2;
+            }
 
             removeNode(ear);
             free(ear);
@@ -495,19 +607,27 @@ void earcutLinked(node_t* ear, triangles_t triangles, coord_t minX, coord_t minY
                 splitEarcut(ear, triangles, minX, minY, invSize);
             }
 
+            // the nodes left belong to the calls above, which may have freed EAR already
+            ear = NULL;
             break;
         }
     }
     
     if (ear && ear->prev == ear->next && ear->prev != NULL) {
     //if (ear->next == ear->prev) {
-        free(ear->next); 
+        // the last two edges are the same one both ways, across two triangles
+        if (ear->half != HALF_NONE && ear->next->half != HALF_NONE) {
+            triangles_link(triangles, (vidx_t)(ear->half / 3), (int)(ear->half % 3), ear->next->half);
+        }
+        untwin(ear->next);
+        untwin(ear);
+        if (ear->next != ear) free(ear->next);
         free(ear);
     }
 }
 
 // find the leftmost node of a polygon ring
-node_t* getLeftmost(node_t* start) {
+static node_t* getLeftmost(node_t* start) {
     node_t *p = start,
            *leftmost = start;
     do {
@@ -517,7 +637,7 @@ node_t* getLeftmost(node_t* start) {
 
     return leftmost;
 }
-int compareX(const void* a, const void* b) {
+static int compareX(const void* a, const void* b) {
     const node_t* an = *(const node_t**)a;
     const node_t* bn = *(const node_t**)b;
     if (an->x < bn->x) return -1;
@@ -527,23 +647,23 @@ int compareX(const void* a, const void* b) {
 }
 
 // whether sector in vertex m contains sector in vertex p in the same coordinates
-bool sectorContainsSector(node_t* m, node_t* p) {
+static bool sectorContainsSector(node_t* m, node_t* p) {
     return area(m->prev, m, p->prev) < 0 && area(p->next, m, m->next) < 0;
 }
 
 // David Eberly's algorithm for finding a bridge between hole and outer polygon
-node_t* findHoleBridge(node_t* hole, node_t* const outerNode) {
+static node_t* findHoleBridge(node_t* hole, node_t* const outerNode) {
     node_t* p = outerNode;
     coord_t hx = hole->x,
-            hy = hole->y,
-            qx = -REAL_MAX_VALUE(qx);
+            hy = hole->y;
+    real_t qx = -REAL_MAX_VALUE(qx);
     node_t* m = NULL;
 
     // find a segment intersected by a ray from the hole's leftmost point to the left;
     // segment's endpoint with lesser x will be potential connection point
     do {
         if (hy <= p->y && hy >= p->next->y && p->next->y != p->y) {
-            coord_t x = p->x + (hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
+            real_t x = p->x + (real_t)(hy - p->y) * (p->next->x - p->x) / (p->next->y - p->y);
             if (x <= hx && x > qx) {
                 qx = x;
                 if (x == hx) {
@@ -565,16 +685,16 @@ node_t* findHoleBridge(node_t* hole, node_t* const outerNode) {
     // otherwise choose the point of the minimum angle with the ray as connection point
     node_t* stop = m;
     coord_t mx = m->x,
-            my = m->y,
-            tanMin = REAL_MAX_VALUE(tanMin),
-            tan;
+            my = m->y;
+    real_t tanMin = REAL_MAX_VALUE(tanMin),
+           tan;
 
     p = m;
     do {
         if (hx >= p->x && p->x >= mx && hx != p->x &&
-                pointInTriangle(hy < my ? hx : qx, hy, mx, my, hy < my ? qx : hx, hy, p->x, p->y)) {
+                pointInTriangle(hy < my ? hx : COORD_FLOOR(qx), hy, mx, my, hy < my ? COORD_FLOOR(qx) : hx, hy, p->x, p->y)) {
 
-            tan = THE_ABS(hy - p->y) / (hx - p->x);  // tangential
+            tan = (real_t)THE_ABS(hy - p->y) / (hx - p->x);  // tangential
 
             if (locallyInside(p, hole) &&
                     (tan < tanMin || (tan == tanMin && (p->x > m->x || (p->x == m->x && sectorContainsSector(m, p)))))) {
@@ -590,7 +710,7 @@ node_t* findHoleBridge(node_t* hole, node_t* const outerNode) {
 }
 
 // find a bridge between vertices that connects hole with an outer ring and and link it
-void eliminateHole(node_t* hole, node_t* outerNode) {
+static void eliminateHole(node_t* hole, node_t* outerNode) {
     outerNode = findHoleBridge(hole, outerNode);
     if (outerNode != NULL) {
         node_t* b = splitPolygon(outerNode, hole);
@@ -602,12 +722,12 @@ void eliminateHole(node_t* hole, node_t* outerNode) {
 }
 
 // link every hole into the outer loop, producing a single-ring polygon without holes
-node_t* eliminateHoles(const vertices_t vertices, const int32_t num, const vidx_t holeIndices[num], node_t* outerNode) {
+static node_t* eliminateHoles(const vertices_t vertices, const vidx_t num, const vidx_t holeIndices[num], const area_t areas[num], node_t* outerNode, coord_t ox, coord_t oy) {
     node_t* queue[num];
-    for (int32_t i = 0; i < num; ++i) {
+    for (vidx_t i = 0; i < num; ++i) {
         vidx_t start = holeIndices[i];
         vidx_t end = i < num - 1 ? holeIndices[i + 1] : vertices_num(vertices);
-        node_t* list = linkedList(vertices, start, end, false);
+        node_t* list = linkedList(vertices, start, end, areas[i], false, ox, oy);
         if (list == list->next) list->steiner = true;
         queue[i] = getLeftmost(list);
     }
@@ -615,58 +735,196 @@ node_t* eliminateHoles(const vertices_t vertices, const int32_t num, const vidx_
     qsort(queue, num, sizeof(queue[0]), compareX);
 
     // process holes from left to right
-    for (int32_t i = 0; i < num; ++i) {
+    for (vidx_t i = 0; i < num; ++i) {
         eliminateHole(queue[i], outerNode);
         outerNode = filterPoints(outerNode, outerNode->next);
     }
     return outerNode;
 }
 
+// every ring needs 3 distinct vertices, no spikes and a non-zero area; fills AREAS like signed_areas()
+static bool validateRings(const vertices_t vertices, const holes_t holes, area_t areas[]) {
+    vidx_t rings = holes != NULL ? holes->num + 1 : 1;
+    for (vidx_t r = 0; r < rings; ++r) {
+        vidx_t start = r == 0 ? 0 : holes->holeIndices[r - 1];
+        vidx_t end = r < rings - 1 ? holes->holeIndices[r] : vertices_num(vertices);
+        area_t area = 0;
+        vidx_t at = start;
+        int res = vertices_validate(vertices, start, end, &area, &at);
+        if (res != VERTICES_VALID) {
+            ERR("POLYGON_EARCUT - ring %" PRIvidx " [%" PRIvidx ", %" PRIvidx ") is invalid at node %" PRIvidx ": %s", r, start, end, at,
+                    res == VERTICES_TOO_FEW ? "less than 3 nodes" :
+                    res == VERTICES_DUPLICATE ? "two consecutive nodes are identical" : "angle is too sharp");
+            return false;
+        }
+        if (area == 0) {
+            ERR("POLYGON_EARCUT - ring %" PRIvidx " [%" PRIvidx ", %" PRIvidx ") has zero area", r, start, end);
+            return false;
+        }
+        areas[r] = area;
+    }
+    return true;
+}
+
+#define MORTON_RADIX_BITS 10
+
+// sorts the triangles M0 on by the z-order of their centroids, in the frame of the z-order hash,
+// with 3 stable counting passes over the 30 bits of the keys
+static bool sortMorton(const vertices_t vertices, triangles_t triangles, vidx_t m0,
+                       coord_t minX, coord_t minY, coord_t maxX, coord_t maxY, zscale_t invSize, coord_t ox, coord_t oy) {
+    const vidx_t num = triangles->m - m0;
+    uint32_t* keys = (uint32_t*) malloc((size_t)num * sizeof(uint32_t));
+    vidx_t* order = (vidx_t*) malloc(2 * (size_t)num * sizeof(vidx_t));
+    size_t* count = (size_t*) malloc(((size_t)1 << MORTON_RADIX_BITS) * sizeof(size_t));
+    bool ok = keys != NULL && order != NULL && count != NULL;
+    if (ok) {
+        for (vidx_t t = 0; t < num; ++t) {
+            const vidx_t* tri = triangles_nth(triangles, m0 + t);
+            area_t cx = 0, cy = 0;
+            for (int k = 0; k < 3; ++k) {
+                cx += vertices_nth_localx(vertices, tri[k]) - ox;
+                cy += vertices_nth_localy(vertices, tri[k]) - oy;
+            }
+            // rounding mustn't take a centroid off the bbox of the hash
+            const coord_t x = THE_MIN(THE_MAX((coord_t)(cx / 3), minX), maxX);
+            const coord_t y = THE_MIN(THE_MAX((coord_t)(cy / 3), minY), maxY);
+            keys[t] = (uint32_t)zOrderKey(x, y, minX, minY, invSize);
+            order[t] = m0 + t;
+        }
+        vidx_t *from = order, *to = order + num;
+        for (int shift = 0; shift < 30; shift += MORTON_RADIX_BITS) {
+            memset(count, 0, ((size_t)1 << MORTON_RADIX_BITS) * sizeof(size_t));
+            for (vidx_t t = 0; t < num; ++t) {
+                count[(keys[from[t] - m0] >> shift) & ((1u << MORTON_RADIX_BITS) - 1)]++;
+            }
+            size_t sum = 0;
+            for (size_t b = 0; b < ((size_t)1 << MORTON_RADIX_BITS); ++b) {
+                const size_t c = count[b];
+                count[b] = sum;
+                sum += c;
+            }
+            for (vidx_t t = 0; t < num; ++t) {
+                to[count[(keys[from[t] - m0] >> shift) & ((1u << MORTON_RADIX_BITS) - 1)]++] = from[t];
+            }
+            vidx_t* swap = from;
+            from = to;
+            to = swap;
+        }
+        ok = triangles_permute(triangles, m0, num, from);
+    }
+    free(count);
+    free(order);
+    free(keys);
+    return ok;
+}
+
+MYIDEF triangles_t polygon_earcut(const vertices_t vertices, const holes_t holes) {
+    return polygon_earcut_ex(vertices, holes, 0);
+}
+
+MYIDEF triangles_t polygon_earcut_ex(const vertices_t vertices, const holes_t holes, unsigned flags) {
+    vidx_t tri_num = vertices->n > 2 ? vertices->n - 2 : 0;
+    if (holes != NULL) {
+        tri_num += 2 * holes->num;
+    }
+    triangles_t triangles = triangles_allocate(tri_num);
+    if (flags & POLY2TRI_ADJACENCY) {
+        triangles_adjacency(triangles, 0, NULL);
+    }
+    if (!polygon_earcut_to(vertices, holes, flags, triangles)) {
+        triangles_free(triangles);
+        return NULL;
+    }
+    return triangles;
+}
+
 /**
  *  This is a derivative work from https://github.com/mapbox/earcut
  */
-MYIDEF triangles_t polygon_earcut(const vertices_t vertices, const holes_t holes) {
+MYIDEF bool polygon_earcut_to(const vertices_t vertices, const holes_t holes, unsigned flags, triangles_t triangles) {
+    // the orientation of every ring, in one sweep
+    area_t areas[holes != NULL ? holes->num + 1 : 1];
+    if (flags & POLY2TRI_VALIDATE) {
+        if (!validateRings(vertices, holes, areas)) {
+            return false;
+        }
+    }
+    else {
+        signed_areas(vertices, holes, areas);
+    }
     bool hasHole = (holes != NULL && holes->num > 0);
     const vidx_t outerLen = hasHole ? holes->holeIndices[0] : vertices->n;
-    node_t* outerNode = linkedList(vertices, 0, outerLen, true);
+
+    // the z-order hash pays off for the shape that isn't too simple, the Morton order always needs it
+    const bool hashed = vertices->n > 80;
+    const bool morton = (flags & POLY2TRI_MORTON) && triangles->sink == NULL;
+
+    // the outer ring's bbox, for the frame origin of a float build and the z-order hash
+    const bool bbox = RECENTER_BUILD || hashed || morton;
+    coord_t minX = 0, minY = 0, maxX = 0, maxY = 0;
+    if (bbox && outerLen > 0) {
+        minX = maxX = vertices_nth_localx(vertices, 0);
+        minY = maxY = vertices_nth_localy(vertices, 0);
+    }
+    for (vidx_t i = 1; bbox && i < outerLen; ++i) {
+        __auto_type xi = vertices_nth_localx(vertices, i);
+        __auto_type yi = vertices_nth_localy(vertices, i);
+        if (xi < minX) minX = xi;
+        if (yi < minY) minY = yi;
+        if (xi > maxX) maxX = xi;
+        if (yi > maxY) maxY = yi;
+    }
+
+    // far-out float input is triangulated about the bbox center; nodes near it subtract exactly
+    coord_t ox = 0, oy = 0;
+    if (RECENTER_WANTED(minX / 2 + maxX / 2, minY / 2 + maxY / 2, THE_MAX(maxX - minX, maxY - minY))) {
+        ox = minX / 2 + maxX / 2;
+        oy = minY / 2 + maxY / 2;
+        minX -= ox;
+        maxX -= ox;
+        minY -= oy;
+        maxY -= oy;
+    }
+
+    node_t* outerNode = linkedList(vertices, 0, outerLen, areas[0], true, ox, oy);
     if (NULL == outerNode || outerNode->next == outerNode->prev) {
         free(outerNode);
-        return NULL;
+        return false;
     }
 
     if (hasHole) {
-        outerNode = eliminateHoles(vertices, holes->num, holes->holeIndices, outerNode);
+        outerNode = eliminateHoles(vertices, holes->num, holes->holeIndices, areas + 1, outerNode, ox, oy);
     }
 
-    coord_t minX = 0, minY = 0, maxX = 0, maxY = 0;
-    coord_t invSize = 0;
-    // if the shape is not too simple, we'll use z-order curve hash later; calculate polygon bbox
-    if (vertices->n > 80) {
-        minX = maxX = vertices_nth_getx(vertices, 0);
-        minY = maxY = vertices_nth_gety(vertices, 0);
-
-        for (vidx_t i = 1; i < outerLen; ++i) {
-            __auto_type xi = vertices_nth_getx(vertices, i);
-            __auto_type yi = vertices_nth_gety(vertices, i);
-            if (xi < minX) minX = xi;
-            if (yi < minY) minY = yi;
-            if (xi > maxX) maxX = xi;
-            if (yi > maxY) maxY = yi;
-        }
-
+    zscale_t invSize = ZSCALE_NONE;
+    if (hashed || morton) {
         // minX, minY and invSize are later used to transform coords into integers for z-order calculation
         __auto_type deltaX = maxX - minX;
         __auto_type deltaY = maxY - minY;
+#ifdef USING_INT32_COORD
+        // already integers, only shifted down into 15 bits
+        invSize = 0;
+        while ((THE_MAX(deltaX, deltaY) >> invSize) > 32767) ++invSize;
+#else
         invSize = THE_MAX(deltaX, deltaY);
         invSize = invSize != 0 ? 1 / invSize : 0;
+#endif
     }
-    vidx_t tri_num = vertices->n - 2;
-    if (hasHole) {
-        tri_num += 2 * holes->num;
+    const vidx_t m0 = triangles->m;
+    earcutLinked(outerNode, triangles, minX, minY, hashed ? invSize : ZSCALE_NONE, 0);
+    if (TRIANGLES_OVERFLOWED(triangles)) {
+        ERR("POLYGON_EARCUT - %" PRIvidx " triangles don't fit into the %" PRIvidx " left",
+                triangles->m - m0, triangles->capacity - (m0 - triangles->base));
+        TRIANGLES_ROLLBACK(triangles, m0);
+        return false;
     }
-    triangles_t triangles = triangles_allocate(tri_num);
-    earcutLinked(outerNode, triangles, minX, minY, invSize, 0);
-    return triangles;
+    if (morton && !sortMorton(vertices, triangles, m0, minX, minY, maxX, maxY, invSize, ox, oy)) {
+        ERR("POLYGON_EARCUT - out of memory sorting %" PRIvidx " triangles", triangles->m - m0);
+        TRIANGLES_ROLLBACK(triangles, m0);
+        return false;
+    }
+    triangles_flush(triangles);
+    return true;
 }
 
 #endif
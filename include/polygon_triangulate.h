@@ -3,15 +3,31 @@
  *
  * https://people.sc.fsu.edu/~jburkardt/c_src/polygon_triangulate/
  */
-#ifndef POLY2TRI_INCLUDE_H
-#define POLY2TRI_INCLUDE_H
-
+// outside the guard, so the implementation can follow the header in the same translation unit
 #ifdef POLY2TRI_IMPLEMENTATION
 #define GEOM_TYPE_IMPLEMENTATION
 #endif
 #include "geometry_type.h"
 
+#ifndef POLY2TRI_INCLUDE_H
+#define POLY2TRI_INCLUDE_H
+
+// the predicates run on vertices_nth_localx(): a recentered clone in its own frame,
+// attached buffers and views as they are
 triangles_t polygon_triangulate(const vertices_t cs);
+triangles_t polygon_triangulate_ex(const vertices_t cs, unsigned flags, area_t area);
+// appends the n-2 triangles to TRIANGLES, e.g. a triangles_attach() of the caller's memory;
+// false when the polygon is rejected or they don't fit, with triangles_num() as it was,
+// though the slots past it may have been written by then.
+// A triangles_stream() is flushed on return. Rejected after a batch went out, the sink has
+// already been handed triangles from the old triangles_num() up to the one it is left at;
+// those belong to the rejected polygon and are the caller's to discard.
+bool polygon_triangulate_to(const vertices_t cs, unsigned flags, area_t area, triangles_t triangles);
+
+// caller-owned memory: WORK of polygon_triangulate_workspace_size(n) bytes, 8-byte aligned,
+// and TRIANGLES of 3*(n-2) indices. Returns the number of triangles, 0 on failure.
+size_t polygon_triangulate_workspace_size(vidx_t n);
+vidx_t polygon_triangulate_work(const vertices_t cs, unsigned flags, area_t area, void* work, vidx_t triangles[]);
 
 #endif // POLY2TRI_INCLUDE_H
 
@@ -24,6 +40,7 @@ triangles_t polygon_triangulate(const vertices_t cs);
 # include <stdlib.h>
 # include <string.h>
 # include <time.h>
+# include <pthread.h>
 
 #include "mylog.h"
 
@@ -57,12 +74,25 @@ triangles_t polygon_triangulate(const vertices_t cs);
 
     Output, int DIAGONALIE, the value of the test.
 */
+// edges gathered per call of intersects_any
+#define DIAGONALIE_BLOCK 64
+
 static bool diagonalie(vidx_t im1, vidx_t ip1, vidx_t next_node[], const vertices_t cs)
 {
     vidx_t first = im1;
     vidx_t j = first;
     vidx_t jp1 = next_node[first];
 
+    __auto_type x_im1 = vertices_nth_localx(cs, im1);
+    __auto_type y_im1 = vertices_nth_localy(cs, im1);
+    __auto_type x_ip1 = vertices_nth_localx(cs, ip1);
+    __auto_type y_ip1 = vertices_nth_localy(cs, ip1);
+
+    // the live edges, packed as the endpoints' coordinates
+    coord_t x_j[DIAGONALIE_BLOCK], y_j[DIAGONALIE_BLOCK];
+    coord_t x_jp1[DIAGONALIE_BLOCK], y_jp1[DIAGONALIE_BLOCK];
+    vidx_t m = 0;
+
     /*
     For each edge VERTEX(J):VERTEX(JP1) of the polygon:
     */
@@ -73,16 +103,15 @@ static bool diagonalie(vidx_t im1, vidx_t ip1, vidx_t next_node[], const vertice
         if ( j == im1 || j == ip1 || jp1 == im1 || jp1 == ip1 ) {
         }
         else {
-            __auto_type x_im1 = vertices_nth_getx(cs, im1);
-            __auto_type y_im1 = vertices_nth_gety(cs, im1);
-            __auto_type x_ip1 = vertices_nth_getx(cs, ip1);
-            __auto_type y_ip1 = vertices_nth_gety(cs, ip1);
-            __auto_type x_j = vertices_nth_getx(cs, j);
-            __auto_type y_j = vertices_nth_gety(cs, j);
-            __auto_type x_jp1 = vertices_nth_getx(cs, jp1);
-            __auto_type y_jp1 = vertices_nth_gety(cs, jp1);
-            if (intersects(x_im1, y_im1, x_ip1, y_ip1, x_j, y_j, x_jp1, y_jp1)) {
-                return false;
+            x_j[m] = vertices_nth_localx(cs, j);
+            y_j[m] = vertices_nth_localy(cs, j);
+            x_jp1[m] = vertices_nth_localx(cs, jp1);
+            y_jp1[m] = vertices_nth_localy(cs, jp1);
+            if (++m == DIAGONALIE_BLOCK) {
+                if (intersects_any(x_im1, y_im1, x_ip1, y_ip1, m, x_j, y_j, x_jp1, y_jp1)) {
+                    return false;
+                }
+                m = 0;
             }
         }
 
@@ -90,7 +119,7 @@ static bool diagonalie(vidx_t im1, vidx_t ip1, vidx_t next_node[], const vertice
         jp1 = next_node[j];
 
         if ( j == first ) {
-            return true;
+            return !intersects_any(x_im1, y_im1, x_ip1, y_ip1, m, x_j, y_j, x_jp1, y_jp1);
         }
     }
 }
@@ -126,14 +155,14 @@ static bool in_cone(vidx_t im1, vidx_t ip1, vidx_t prev_node[], vidx_t next_node
     __auto_type im2 = prev_node[im1];
     __auto_type i   = next_node[im1];
 
-    __auto_type x_im1 = vertices_nth_getx(cs, im1);
-    __auto_type y_im1 = vertices_nth_gety(cs, im1);
-    __auto_type x_im2 = vertices_nth_getx(cs, im2);
-    __auto_type y_im2 = vertices_nth_gety(cs, im2);
-    __auto_type x_ip1 = vertices_nth_getx(cs, ip1);
-    __auto_type y_ip1 = vertices_nth_gety(cs, ip1);
-    __auto_type x_i = vertices_nth_getx(cs, i);
-    __auto_type y_i = vertices_nth_gety(cs, i);
+    __auto_type x_im1 = vertices_nth_localx(cs, im1);
+    __auto_type y_im1 = vertices_nth_localy(cs, im1);
+    __auto_type x_im2 = vertices_nth_localx(cs, im2);
+    __auto_type y_im2 = vertices_nth_localy(cs, im2);
+    __auto_type x_ip1 = vertices_nth_localx(cs, ip1);
+    __auto_type y_ip1 = vertices_nth_localy(cs, ip1);
+    __auto_type x_i = vertices_nth_localx(cs, i);
+    __auto_type y_i = vertices_nth_localy(cs, i);
     if (0.0 <= triangle_area(x_im1, y_im1, x_i, y_i, x_im2, y_im2)) {
         bool t2 = triangle_area(x_im1, y_im1, x_ip1, y_ip1, x_im2, y_im2) > 0.0;
         bool t3 = triangle_area(x_ip1, y_ip1, x_im1, y_im1, x_i, y_i) > 0.0;
@@ -173,7 +202,7 @@ static bool in_cone(vidx_t im1, vidx_t ip1, vidx_t prev_node[], vidx_t next_node
 
     Output, int DIAGONAL, the value of the test.
 */
-bool diagonal(vidx_t im1, vidx_t ip1, vidx_t prev_node[], vidx_t next_node[], const vertices_t cs)
+static bool diagonal(vidx_t im1, vidx_t ip1, vidx_t prev_node[], vidx_t next_node[], const vertices_t cs)
 {
     bool value1 = in_cone(im1, ip1, prev_node, next_node, cs);
     bool value2 = in_cone(ip1, im1, prev_node, next_node, cs);
@@ -182,6 +211,177 @@ bool diagonal(vidx_t im1, vidx_t ip1, vidx_t prev_node[], vidx_t next_node[], co
     return ( value1 && value2 && value3 );
 }
 
+// below this many vertices per thread, spawning threads costs more than it saves
+#define EAR_MT_MIN_CHUNK 128
+
+struct ear_task {
+    vidx_t lo;
+    vidx_t hi;
+    vidx_t* prev_node;
+    vidx_t* next_node;
+    vertices_t cs;
+    bool* ear;
+};
+
+static void* ear_classify(void* arg) {
+    struct ear_task* task = (struct ear_task*)arg;
+    for (vidx_t i = task->lo; i < task->hi; i++ ) {
+        task->ear[i] = diagonal(task->prev_node[i], task->next_node[i], task->prev_node, task->next_node, task->cs);
+    }
+    return NULL;
+}
+
+/**
+ * EAR[I] only reads the initial PREV_NODE/NEXT_NODE links and writes its own slot,
+ * so the vertices are split into contiguous ranges, one per thread.
+ * The calling thread takes the first range and any range whose thread failed to start.
+ */
+static void ears_init(vidx_t n, int threads, vidx_t prev_node[], vidx_t next_node[], const vertices_t cs, bool ear[]) {
+    int nthreads = THE_MAX(1, THE_MIN(THE_MIN(threads, POLY2TRI_THREADS_MAX), n / EAR_MT_MIN_CHUNK));
+    struct ear_task tasks[POLY2TRI_THREADS_MAX];
+    pthread_t tids[POLY2TRI_THREADS_MAX];
+    bool started[POLY2TRI_THREADS_MAX];
+
+    for (int t = 0; t < nthreads; ++t) {
+        tasks[t] = (struct ear_task) {
+            .lo = (vidx_t)((int64_t)n * t / nthreads),
+            .hi = (vidx_t)((int64_t)n * (t + 1) / nthreads),
+            .prev_node = prev_node,
+            .next_node = next_node,
+            .cs = cs,
+            .ear = ear,
+        };
+        started[t] = t > 0 && pthread_create(&tids[t], NULL, ear_classify, &tasks[t]) == 0;
+    }
+    for (int t = 0; t < nthreads; ++t) {
+        if (!started[t]) ear_classify(&tasks[t]);
+    }
+    for (int t = 1; t < nthreads; ++t) {
+        if (started[t]) pthread_join(tids[t], NULL);
+    }
+}
+
+/**
+ * set up the links and the ears, then cut N-2 triangles into TRIANGLES.
+ * A clockwise polygon is walked backwards: swapping the links gives a counter-clockwise
+ * view of the same vertices, so nothing is copied and the triangles keep the caller's indices.
+ * With HALF, the half-edge across the edge from each node to its next, the cuts link up as
+ * they go, see triangles_adjacency(). The initial ears are classified on THREADS threads.
+ */
+static bool triangulate_ears(const vertices_t cs, bool clockwise, int threads, vidx_t prev_node[], vidx_t next_node[], bool ear[], triangles_t triangles, size_t half[])
+{
+    const vidx_t n = cs->n;
+    vidx_t* succ = clockwise ? prev_node : next_node;
+    vidx_t* pred = clockwise ? next_node : prev_node;
+    for (vidx_t i = 0; i < (vidx_t)n; i++ ) {
+        pred[i] = (i - 1 + n) % n;
+        succ[i] = (i + 1) % n;
+    }
+
+    ears_init(n, threads, prev_node, next_node, cs, ear);
+    if (half != NULL) {
+        // the polygon's own edges, nothing across them
+        for (vidx_t i = 0; i < n; i++) half[i] = HALF_NONE;
+    }
+
+    // the cuts of this polygon, TRIANGLES may hold others before them
+    const vidx_t m0 = triangles->m;
+    vidx_t triangle_idx = 0;
+    // vertices visited since the last cut, a whole lap without an ear means the input lied
+    vidx_t misses = 0;
+
+    vidx_t i0;
+    vidx_t i1;
+    vidx_t i2;
+    vidx_t i3;
+    vidx_t i4;
+
+    // the first vertex of the view
+    i2 = clockwise ? n - 1 : 0;
+    while (triangle_idx < n - 3) {
+        // If I2 is an ear, gather information necessary to carry out
+        // the slicing operation and subsequent "healing".
+        if (ear[i2]) {
+            i3 = next_node[i2];
+            i4 = next_node[i3];
+            i1 = prev_node[i2];
+            i0 = prev_node[i1];
+            // Make vertex I2 disappear.
+            next_node[i1] = i3;
+            prev_node[i3] = i1;
+            // Update the earity of I1 and I3, because I2 disappeared.
+            ear[i1] = diagonal ( i0, i3, prev_node, next_node, cs);
+            ear[i3] = diagonal ( i1, i4, prev_node, next_node, cs);
+            // Add the diagonal [I3, I1, I2] to the list.
+            triangle_idx = triangles_append(triangles, i3, i1, i2) - m0;
+            if (half != NULL) {
+                // I1:I2 and I2:I3 are taken, I3:I1 is new and I1's edge from now on
+                vidx_t t = m0 + triangle_idx - 1;
+                triangles_link(triangles, t, 0, HALF_NONE);
+                triangles_link(triangles, t, 1, half[i1]);
+                triangles_link(triangles, t, 2, half[i2]);
+                half[i1] = 3 * (size_t)t;
+            }
+            misses = 0;
+        }
+        else if (++misses > n) {
+            return false;
+        }
+        // Try the next vertex.
+        i2 = next_node[i2];
+    }
+    // The last triangle is formed from the three remaining vertices.
+    i3 = next_node[i2];
+    i1 = prev_node[i2];
+
+    vidx_t t = triangles_append(triangles, i3, i1, i2) - 1;
+    if (half != NULL) {
+        triangles_link(triangles, t, 0, half[i3]);
+        triangles_link(triangles, t, 1, half[i1]);
+        triangles_link(triangles, t, 2, half[i2]);
+    }
+    return true;
+}
+
+#define angle_tol ANGLE_TOL_DEGREE
+// One fused pass over the vertices, stops at the first offending node.
+// A non-zero AREA is taken from the caller instead of being recomputed.
+static bool triangulate_validate(const vertices_t cs, area_t* area)
+{
+    vidx_t at = 0;
+    switch (vertices_validate(cs, 0, cs->n, *area != 0.0 ? NULL : area, &at)) {
+    // We must have at least 3 vertices.
+    case VERTICES_TOO_FEW:
+        ERR("POLYGON_TRIANGULATE - Fatal error!  N < 3." );
+        return false;
+    // Consecutive vertices cannot be equal.
+    case VERTICES_DUPLICATE:
+        ERR("POLYGON_TRIANGULATE - Fatal error!  Two consecutive nodes are identical." );
+        return false;
+    // No node can be the vertex of an angle less than 1 degree
+    // in absolute value.
+    case VERTICES_SHARP_ANGLE:
+        ERR("POLYGON_TRIANGULATE - Fatal error! Polygon has an angle smaller than %g, accurring at node %" PRIvidx, angle_tol, at);
+        return false;
+    }
+    // Area must not vanish, its sign gives the orientation.
+    if (*area == 0.0) {
+        ERR("POLYGON_TRIANGULATE - Fatal error!  Polygon has zero area." );
+        return false;
+    }
+    return true;
+}
+
+// on success AREA is left with the sign of the polygon's orientation
+static bool triangulate_accepts(const vertices_t cs, unsigned flags, area_t* area)
+{
+    if (flags & POLY2TRI_TRUSTED) {
+        // The caller vouches for the vertices, only guard against what would crash.
+        return cs->n >= 3;
+    }
+    return triangulate_validate(cs, area);
+}
+
 /**
   Purpose:
     POLYGON_TRIANGULATE determines a triangulation of a polygon.
@@ -213,107 +413,104 @@ bool diagonal(vidx_t im1, vidx_t ip1, vidx_t prev_node[], vidx_t next_node[], co
     LC: QA448.D38.
 
   Parameters:
-    Input, int N, the number of vertices. MUST BE counter-clockwise
+    Input, int N, the number of vertices, either counter-clockwise or clockwise.
     Input, double X[N], Y[N], the coordinates of each vertex.
+    Input, FLAGS, POLY2TRI_TRUSTED skips the validation of the vertices.
+    Input, AREA, the signed area of the polygon if known by the caller, otherwise 0.
+      A non-zero AREA is not checked against the vertices, it is summed only when 0.
+      With POLY2TRI_TRUSTED its sign is the orientation, 0 is taken as counter-clockwise.
 
     Output, int TRIANGLES[3*(N-2)], the triangles of the triangulation.
 */
-#define angle_tol 5.7E-05
 MYIDEF triangles_t polygon_triangulate(const vertices_t cs)
 {
-    const vidx_t n = cs->n;
-    // We must have at least 3 vertices.
-    if (n < 3) {
-        ERR("POLYGON_TRIANGULATE - Fatal error!  N < 3." );
-        return NULL;
-    }
-    // Consecutive vertices cannot be equal.
-    for (vidx_t curt = 0, prev = n-1; curt < n; curt++ ) {
-        if ( vertices_nth_getx(cs, prev) == vertices_nth_getx(cs, curt) && vertices_nth_gety(cs, prev) == vertices_nth_gety(cs, curt) ) {
-          ERR("POLYGON_TRIANGULATE - Fatal error!  Two consecutive nodes are identical." );
-          return NULL;
-        }
-        prev = curt;
-    }
-    // No node can be the vertex of an angle less than 1 degree 
-    // in absolute value.
-    for (vidx_t curt = 0, prev = n-1; curt < n; curt++ ) {
-        vidx_t next = ( ( curt + 1 ) % n ); 
-
-        __auto_type angle = angle_degree(vertices_nth_getx(cs, prev), vertices_nth_gety(cs, prev), 
-                                         vertices_nth_getx(cs, curt), vertices_nth_gety(cs, curt), 
-                                         vertices_nth_getx(cs, next), vertices_nth_gety(cs, next) );
+    return polygon_triangulate_ex(cs, 0, 0);
+}
 
-        if ( THE_ABS( angle ) <= angle_tol ) {
-            ERR("POLYGON_TRIANGULATE - Fatal error! Polygon has an angle smaller than %g, accurring at node %d", angle_tol, curt);
-            return NULL;
-        }
-        prev = curt;
+MYIDEF triangles_t polygon_triangulate_ex(const vertices_t cs, unsigned flags, area_t area)
+{
+    triangles_t triangles = triangles_allocate(cs->n > 2 ? cs->n - 2 : 0);
+    if (flags & POLY2TRI_ADJACENCY) {
+        triangles_adjacency(triangles, 0, NULL);
     }
-    // Area must be positive.
-    if (signed_area(cs, 0, cs->n) <= 0.0) {
-        ERR("POLYGON_TRIANGULATE - Fatal error!  Polygon has zero or negative area." );
+    if (!polygon_triangulate_to(cs, flags, area, triangles)) {
+        triangles_free(triangles);
         return NULL;
     }
+    return triangles;
+}
 
-    triangles_t triangles = triangles_allocate(n - 2);
+MYIDEF bool polygon_triangulate_to(const vertices_t cs, unsigned flags, area_t area, triangles_t triangles)
+{
+    const vidx_t n = cs->n;
+    if (!triangulate_accepts(cs, flags, &area)) {
+        return false;
+    }
+    // the count is known up front, nothing gets cut into a buffer too small
+    const vidx_t m0 = triangles->m;
+    if (triangles->sink == NULL && triangles->capacity - (m0 - triangles->base) < n - 2) {
+        ERR("POLYGON_TRIANGULATE - %" PRIvidx " triangles don't fit into the %" PRIvidx " left",
+                n - 2, triangles->capacity - (m0 - triangles->base));
+        return false;
+    }
 
     // PREV_NODE and NEXT_NODE point to the previous and next nodes.
     vidx_t* prev_node = (__typeof__(prev_node)) malloc ( n * sizeof ( *prev_node ) );
     vidx_t* next_node = (__typeof__(next_node)) malloc ( n * sizeof ( *next_node ) );
-
-    for (vidx_t i = 0; i < (vidx_t)n; i++ ) {
-        prev_node[i] = (i - 1 + n) % n;
-        next_node[i] = (i + 1) % n;
-    }
-
     // EAR indicates whether the node and its immediate neighbors form an ear
     // that can be sliced off immediately.
     bool* ear = (__typeof__(ear)) malloc ( n * sizeof ( *ear ) );
-    for (vidx_t i = 0; i < (vidx_t)n; i++ ) {
-        ear[i] = diagonal(prev_node[i], next_node[i], prev_node, next_node, cs);
+    // HALF links the triangles up, only wanted with adjacency
+    size_t* half = triangles->adj != NULL ? (__typeof__(half)) malloc ( n * sizeof ( *half ) ) : NULL;
+
+    bool cut = triangulate_ears(cs, area < 0.0, POLY2TRI_THREADS_OF(flags), prev_node, next_node, ear, triangles, half);
+    if (!cut) {
+        ERR("POLYGON_TRIANGULATE - Fatal error!  No ear left to cut, wrong orientation?" );
+        // a stream may have seen the first of them already
+        TRIANGLES_ROLLBACK(triangles, m0);
+    }
+    else {
+        triangles_flush(triangles);
     }
 
-    vidx_t triangle_idx = 0;
+    free ( half );
+    free ( ear );
+    free ( next_node );
+    free ( prev_node );
 
-    vidx_t i0;
-    vidx_t i1;
-    vidx_t i2;
-    vidx_t i3;
-    vidx_t i4;
+    return cut;
+}
 
-    i2 = 0;
-    while (triangle_idx < n - 3) {
-        // If I2 is an ear, gather information necessary to carry out
-        // the slicing operation and subsequent "healing".
-        if (ear[i2]) {
-            i3 = next_node[i2];
-            i4 = next_node[i3];
-            i1 = prev_node[i2];
-            i0 = prev_node[i1];
-            // Make vertex I2 disappear.
-            next_node[i1] = i3;
-            prev_node[i3] = i1;
-            // Update the earity of I1 and I3, because I2 disappeared.
-            ear[i1] = diagonal ( i0, i3, prev_node, next_node, cs);
-            ear[i3] = diagonal ( i1, i4, prev_node, next_node, cs);
-            // Add the diagonal [I3, I1, I2] to the list.
-            triangle_idx = triangles_append(triangles, i3, i1, i2);
-        }
-        // Try the next vertex.
-        i2 = next_node[i2];
+// the workspace holds the triangles_t header wrapping the caller's buffer, PREV_NODE, NEXT_NODE and EAR
+#define WORKSPACE_LINKS_OFFSET ((sizeof(struct triangles_s) + 7) & ~(size_t)7)
+
+MYIDEF size_t polygon_triangulate_workspace_size(vidx_t n)
+{
+    return WORKSPACE_LINKS_OFFSET + 2 * (size_t)n * sizeof(vidx_t) + (size_t)n * sizeof(bool);
+}
+
+MYIDEF vidx_t polygon_triangulate_work(const vertices_t cs, unsigned flags, area_t area, void* work, vidx_t triangles[])
+{
+    const vidx_t n = cs->n;
+    if (!triangulate_accepts(cs, flags, &area)) {
+        return 0;
     }
-    // The last triangle is formed from the three remaining vertices.
-    i3 = next_node[i2];
-    i1 = prev_node[i2];
 
-    triangles_append(triangles, i3, i1, i2);
+    // no memset of the output, every slot of the n-2 triangles gets written
+    triangles_t wrapped = (triangles_t) work;
+    *wrapped = (struct triangles_s) {
+        .capacity = n - 2,
+        .vidx = triangles,
+    };
 
-    free ( ear );
-    free ( next_node );
-    free ( prev_node );
+    vidx_t* prev_node = (vidx_t*) ((char*) work + WORKSPACE_LINKS_OFFSET);
+    vidx_t* next_node = prev_node + n;
+    bool* ear = (bool*) (next_node + n);
 
-    return triangles;
+    if (!triangulate_ears(cs, area < 0.0, POLY2TRI_THREADS_OF(flags), prev_node, next_node, ear, wrapped, NULL)) {
+        return 0;
+    }
+    return wrapped->m;
 }
 
 #endif // POLY2TRI_IMPLEMENTATION
@@ -0,0 +1,96 @@
+/**
+ * The caller's side of the accessors: each loop below crosses into the library per vertex
+ * or per triangle unless POLY2TRI_STATIC_INLINE compiles the accessors into this unit.
+ *
+ *   ./bench.run [n] [rounds]
+ */
+#define _DEFAULT_SOURCE // clock_gettime(), M_PI
+#include "mylog.h"
+#include "polygon_triangulate.h"
+#include "polygon_earcut.h"
+#include <stdio.h>
+#include <time.h>
+
+static double now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// a star-shaped ring, counterclockwise, every other vertex pulled in
+static vertices_t star_ring(vidx_t n) {
+    vertices_t vs = vertices_allocate(n);
+    for (vidx_t i = 0; i < n; ++i) {
+        double a = 2 * M_PI * i / n;
+        double r = (i & 1) ? 60 : 100;
+        vertices_nth_setxy(vs, i, (coord_t)(r * cos(a)), (coord_t)(r * sin(a)));
+    }
+    return vs;
+}
+
+// twice the area of the triangulation, one triangle_area() and six accessors a triangle
+static area_t mesh_area(const vertices_t vs, triangles_t ts) {
+    area_t sum = 0;
+    for (vidx_t t = 0; t < triangles_num(ts); ++t) {
+        const vidx_t* tri = triangles_nth(ts, t);
+        sum += triangle_area(vertices_nth_getx(vs, tri[0]), vertices_nth_gety(vs, tri[0]),
+                             vertices_nth_getx(vs, tri[1]), vertices_nth_gety(vs, tri[1]),
+                             vertices_nth_getx(vs, tri[2]), vertices_nth_gety(vs, tri[2]));
+    }
+    return sum;
+}
+
+// a fan over the ring, built through triangles_append()
+static vidx_t fan(const vertices_t vs, triangles_t ts) {
+    vidx_t n = vertices_num(vs);
+    for (vidx_t i = 1; i + 1 < n; ++i) {
+        triangles_append(ts, 0, i, i + 1);
+    }
+    return triangles_num(ts);
+}
+
+int main(int argc, char* argv[]) {
+    vidx_t n = argc > 1 ? (vidx_t)atoi(argv[1]) : 2000;
+    int rounds = argc > 2 ? atoi(argv[2]) : 2000;
+    vertices_t vs = star_ring(n);
+    triangles_t ts = polygon_earcut(vs, NULL);
+
+    double t0 = now();
+    volatile area_t area = 0;
+    for (int r = 0; r < rounds; ++r) {
+        area += mesh_area(vs, ts);
+    }
+    double t1 = now();
+    volatile vidx_t m = 0;
+    double appending = 0;
+    for (int r = 0; r < rounds; ++r) {
+        // allocated outside the clock
+        triangles_t fs = triangles_allocate(n - 2);
+        double s = now();
+        m += fan(vs, fs);
+        appending += now() - s;
+        triangles_free(fs);
+    }
+    double t2 = now();
+    for (int r = 0; r < rounds / 100 + 1; ++r) {
+        triangles_t es = polygon_earcut(vs, NULL);
+        m += triangles_num(es);
+        triangles_free(es);
+    }
+    double t3 = now();
+
+    printf("%-14s n=%" PRIvidx " rounds=%d  area %7.3f ns/tri  append %7.3f ns/tri  earcut %8.3f us\n",
+#ifdef POLY2TRI_STATIC_INLINE
+           "static inline",
+#else
+           "extern",
+#endif
+           n, rounds,
+           (t1 - t0) * 1e9 / ((double)rounds * triangles_num(ts)),
+           appending * 1e9 / ((double)rounds * (n - 2)),
+           (t3 - t2) * 1e6 / (rounds / 100 + 1));
+
+    triangles_free(ts);
+    vertices_destroy(vs);
+    return 0;
+}
@@ -0,0 +1,5 @@
+// the library side, built on its own like a shared object would be
+
+#define POLY2TRI_IMPLEMENTATION
+#include "polygon_triangulate.h"
+#include "polygon_earcut.h"
@@ -0,0 +1,124 @@
+
+const coord_t x[] = {
+    4962,
+    5571,
+    6061,
+    6449,
+    6271,
+    5932,
+    5689,
+    5398,
+    5005,
+    4860,
+    4817,
+    4935,
+    4957,
+    4968,
+    4898,
+    4779,
+    4618,
+    4575,
+    4569,
+    4564,
+    4483,
+    4375,
+    4181,
+    4052,
+    3961,
+    3815,
+    3691,
+    3514,
+    3298,
+    3347,
+    3487,
+    3546,
+    3724,
+    3605,
+    3390,
+    3142,
+    2798,
+    2722,
+    2561,
+    2496,
+    2561,
+    2873,
+    2970,
+    3228,
+    3126,
+    2884,
+    2518,
+    2313,
+    2151,
+    2130,
+    2351,
+    2507,
+    2894,
+    2991,
+    3061,
+    3131,
+    3239,
+    3363,
+    3562,
+};
+const coord_t y[] = {
+    2086,
+    3199,
+    4158,
+    5009,
+    5344,
+    5127,
+    4692,
+    4240,
+    4339,
+    5018,
+    5697,
+    6638,
+    7335,
+    7833,
+    8403,
+    8557,
+    8502,
+    8222,
+    7706,
+    7362,
+    6783,
+    6122,
+    5950,
+    6421,
+    7145,
+    7733,
+    8620,
+    8855,
+    8665,
+    8176,
+    7443,
+    6882,
+    5860,
+    5860,
+    6412,
+    7018,
+    8113,
+    8158,
+    8086,
+    7869,
+    7543,
+    6566,
+    6222,
+    5371,
+    5308,
+    5579,
+    6267,
+    6575,
+    6566,
+    6213,
+    5724,
+    5353,
+    4611,
+    4204,
+    3633,
+    3190,
+    2647,
+    2357,
+    2176,
+};
+
@@ -11,3 +11,20 @@
 #define POLY2TRI_IMPLEMENTATION
 #include "polygon_earcut.h"
 
+
+// sortLinked() on its own: N nodes keyed by Z[] in a list, their indices in sorted order into ORDER
+vidx_t earcut_sort_keys(vidx_t n, const coord_t z[], vidx_t order[]) {
+    node_t* nodes = (node_t*)calloc(n > 0 ? n : 1, sizeof(node_t));
+    for (vidx_t i = 0; i < n; ++i) {
+        nodes[i].i = i;
+        nodes[i].z = z[i];
+        nodes[i].prevZ = i > 0 ? &nodes[i - 1] : NULL;
+        nodes[i].nextZ = i + 1 < n ? &nodes[i + 1] : NULL;
+    }
+    vidx_t k = 0;
+    for (node_t* p = sortLinked(n > 0 ? nodes : NULL); p != NULL; p = p->nextZ) {
+        order[k++] = p->i;
+    }
+    free(nodes);
+    return k;
+}
@@ -23,8 +23,8 @@ TEST area_eq_test(vertices_t vertices, holes_t holes) {
 TEST as_expected_and_area_eq_test(vertices_t vertices, holes_t holes, const int32_t tnum, const boxed_triangle expected_triangles[tnum]) {
     const triangles_t triangles = polygon_earcut(vertices, holes);
     ASSERT(NULL != triangles);
-    DBG("tri -> num: %d", triangles_num(triangles));
-    ASSERT_EQ_FMT(tnum, triangles_num(triangles), "%d");
+    DBG("tri -> num: %" PRIvidx, triangles_num(triangles));
+    ASSERT_EQ_FMT((vidx_t)tnum, triangles_num(triangles), "%" PRIvidx);
 
     vidx_t* tri = triangles_nth(triangles, 0);
     ASSERT_EQUAL_T(expected_triangles, tri, &boxed_triangle_type_info, NULL);
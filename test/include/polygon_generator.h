@@ -13,7 +13,7 @@ vertices_t polygon_generate(vidx_t num);
 
 struct angle_ix {
     vidx_t i;
-    coord_t angle;
+    real_t angle;
 };
 
 int angle_comp(const void *a1, const void *a2) {
@@ -31,8 +31,14 @@ MYIDEF vertices_t polygon_generate(vidx_t num) {
             maxy = -REAL_MAX_VALUE(maxy);
     vertices_t vertices = vertices_allocate(num);
     for (int i=0; i<num; ++i) {
+#ifdef USING_INT32_COORD
+        // a 65536 tile extent
+        coord_t tx = (coord_t) (rand() % 65536);
+        coord_t ty = (coord_t) (rand() % 65536);
+#else
         coord_t tx = (coord_t) rand() / RAND_MAX * 100;
         coord_t ty = (coord_t) rand() / RAND_MAX * 100;
+#endif
         vertices_nth_setxy(vertices, i, tx, ty);
         if (tx < minx) minx = tx;
         if (tx > maxx) maxx = tx;
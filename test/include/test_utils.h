@@ -3,6 +3,7 @@
 
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "mylog.h"
 #include "geometry_type.h"
@@ -37,6 +38,8 @@ void print_polygon(vertices_t poly);
 coord_t diff_areas(polygon_t polygon, triangles_t triangles);
 void reverse_polygon(vertices_t poly);
 void sort_triangles(int num, boxed_triangle triangles[num]);
+int adjacency_boundary(triangles_t triangles);
+bool strip_matches(triangles_t triangles, size_t len, const vidx_t strip[]);
 
 extern greatest_type_info boxed_triangle_type_info;
 #endif // TEST_UTILS_H
@@ -67,7 +70,7 @@ int boxed_triangle_eq(const void *exp, const void *got, void *udata) {
 int boxed_triangle_pt(const void *got, void *udata) {
     const boxed_triangle *gtri = (const boxed_triangle*) got;
     (void)udata;
-    return printf("triagle{%d,%d,%d}", gtri->tri[0],gtri->tri[1],gtri->tri[2]);
+    return printf("triagle{%" PRIvidx ",%" PRIvidx ",%" PRIvidx "}", gtri->tri[0],gtri->tri[1],gtri->tri[2]);
 }
 
 greatest_type_info boxed_triangle_type_info = {
@@ -122,25 +125,91 @@ coord_t diff_areas(polygon_t polygon, triangles_t triangles) {
         areas += THE_ABS(triangle_area(ax,ay, bx,by, cx,cy));
     }
     __auto_type diff = 1 - areas/darea;
-    DBG("polygon[#%d].area: %.4f - triangles[#%d].area: %.4f = %g", vertices_num(vertices), darea, m, areas, diff);
+    DBG("polygon[#%" PRIvidx "].area: %.4f - triangles[#%" PRIvidx "].area: %.4f = %g", vertices_num(vertices), (double)darea, m, areas, diff);
     return THE_ABS(diff);
 }
 
+// the edges without a neighbour, -1 when a neighbour doesn't share the edge or doesn't link back
+int adjacency_boundary(triangles_t triangles) {
+    int boundary = 0;
+    for (vidx_t t = 0; t < triangles_num(triangles); ++t) {
+        const vidx_t* tri = triangles_nth(triangles, t);
+        const vidx_t* adj = triangles_nth_adjacent(triangles, t);
+        for (int k = 0; k < 3; ++k) {
+            if (adj[k] == VIDX_NONE) {
+                boundary++;
+                continue;
+            }
+            const vidx_t* other = triangles_nth(triangles, adj[k]);
+            const vidx_t* back = triangles_nth_adjacent(triangles, adj[k]);
+            bool shared = false;
+            for (int j = 0; j < 3; ++j) {
+                shared |= other[j] == tri[(k + 1) % 3] && other[(j + 1) % 3] == tri[k] && back[j] == t;
+            }
+            if (!shared) {
+                DBG("triangle %" PRIvidx " edge %d: %" PRIvidx " doesn't link back", t, k, adj[k]);
+                return -1;
+            }
+        }
+    }
+    return boundary;
+}
+
+// the strips of triangles_strip() unwound are the same triangles, the same way round
+bool strip_matches(triangles_t triangles, size_t len, const vidx_t strip[]) {
+    const vidx_t m = triangles_num(triangles);
+    boxed_triangle* expected = malloc(m * sizeof(boxed_triangle));
+    boxed_triangle* got = malloc(m * sizeof(boxed_triangle));
+    for (vidx_t t = 0; t < m; ++t) {
+        memcpy(expected[t].tri, triangles_nth(triangles, t), sizeof(expected[t].tri));
+    }
+    size_t n = 0, start = 0;
+    bool ok = true;
+    for (size_t i = 0; i <= len; ++i) {
+        if (i < len && strip[i] != VIDX_NONE) {
+            if (i - start >= 2) {
+                const bool odd = (i - start) % 2 == 1;
+                if (n == (size_t)m) {
+                    ok = false;
+                    break;
+                }
+                got[n++] = (boxed_triangle){{ strip[i - 1 - !odd], strip[i - 1 - odd], strip[i] }};
+            }
+            continue;
+        }
+        start = i + 1;
+    }
+    if (ok && n == (size_t)m) {
+        sort_triangles(m, expected);
+        sort_triangles(m, got);
+        for (vidx_t t = 0; t < m && ok; ++t) {
+            ok = triangle_cmp(&expected[t], &got[t]) == 0;
+        }
+    }
+    else {
+        DBG("%zu triangles in the strips, %" PRIvidx " expected", n, m);
+        ok = false;
+    }
+    free(got);
+    free(expected);
+    return ok;
+}
+
 void print_polygon(vertices_t poly) {
     vidx_t vnum = vertices_num(poly);
-    printf("polygon n=%d\n\t", vnum);
+    printf("polygon n=%" PRIvidx "\n\t", vnum);
     for (int i=0; i<vnum; ++i) {
-        printf("%d:[%g,%g], ", i, vertices_nth_getx(poly, i), vertices_nth_gety(poly, i));
+        printf("%d:[%g,%g], ", i, (double)vertices_nth_getx(poly, i), (double)vertices_nth_gety(poly, i));
     }
     printf("\n");
 }
 
 void print_triangles(triangles_t triangles) {
     __auto_type m = triangles_num(triangles);
-    printf("triangles #%d\n", m);
+    printf("triangles #%" PRIvidx "\n", m);
     for (int i=0; i<m; ++i) {
         vidx_t* tri = triangles_nth(triangles, i);
-        printf("\t%d:{%d, %d, %d}\n", i, tri[0], tri[1], tri[2]);
+        printf("\t%d:{%" PRIvidx ", %" PRIvidx ", %" PRIvidx "}\n", i, tri[0], tri[1], tri[2]);
     }
     printf("\n");
 }
@@ -0,0 +1,138 @@
+#define _DEFAULT_SOURCE // M_PI
+#include "mylog.h"
+#include "greatest.h"
+#include "poly2tri_instance.h"
+#include <math.h>
+
+POLY2TRI_DECLARE_INSTANCE(p2t_f32i16_, float, float, float, int16_t)
+POLY2TRI_DECLARE_INSTANCE(p2t_f64i32_, double, double, double, int32_t)
+
+// float keeps about 7 digits, beyond that the predicates lose the shape
+#define F32_EXTENT 1e5
+
+// the number of triangles, by the instantiation fitting N and the extent of X, Y
+static int32_t earcut_any(int32_t n, const double x[n], const double y[n], int* picked) {
+    double extent = 0;
+    for (int32_t i = 0; i < n; ++i) {
+        extent = fmax(extent, fmax(fabs(x[i]), fabs(y[i])));
+    }
+    int32_t m = 0;
+    if (n <= INT16_MAX && extent < F32_EXTENT) {
+        *picked = 16;
+        p2t_f32i16_vertices_t vs = p2t_f32i16_vertices_clone_doubles((int16_t)n, x, y);
+        p2t_f32i16_triangles_t ts = p2t_f32i16_polygon_earcut(vs, NULL);
+        m = ts != NULL ? p2t_f32i16_triangles_num(ts) : 0;
+        p2t_f32i16_triangles_free(ts);
+        p2t_f32i16_vertices_destroy(vs);
+    }
+    else {
+        *picked = 32;
+        p2t_f64i32_vertices_t vs = p2t_f64i32_vertices_attach(n, x, y);
+        p2t_f64i32_triangles_t ts = p2t_f64i32_polygon_earcut(vs, NULL);
+        m = ts != NULL ? p2t_f64i32_triangles_num(ts) : 0;
+        p2t_f64i32_triangles_free(ts);
+        p2t_f64i32_vertices_destroy(vs);
+    }
+    return m;
+}
+
+// a counterclockwise ring of N vertices about (CX, CY), every other vertex pulled in
+static void star_ring(int32_t n, double cx, double cy, double r, double x[n], double y[n]) {
+    for (int32_t i = 0; i < n; ++i) {
+        double a = 2 * M_PI * i / n;
+        double ri = (i & 1) ? r * 0.6 : r;
+        x[i] = cx + ri * cos(a);
+        y[i] = cy + ri * sin(a);
+    }
+}
+
+TEST same_result_test(void) {
+    // counterclockwise, with a clockwise hole
+    const float xf[] = { 0, 10, 10, 0, 3, 3, 7, 7 };
+    const float yf[] = { 0, 0, 10, 10, 3, 7, 7, 3 };
+    const double xd[] = { 0, 10, 10, 0, 3, 3, 7, 7 };
+    const double yd[] = { 0, 0, 10, 10, 3, 7, 7, 3 };
+
+    p2t_f32i16_vertices_t v16 = p2t_f32i16_vertices_attach(8, xf, yf);
+    p2t_f32i16_holes_t h16 = p2t_f32i16_holes_create_int16(1, (const int16_t[]){ 4 });
+    p2t_f32i16_triangles_t t16 = p2t_f32i16_polygon_earcut(v16, h16);
+    ASSERT(t16 != NULL);
+
+    p2t_f64i32_vertices_t v32 = p2t_f64i32_vertices_attach(8, xd, yd);
+    p2t_f64i32_holes_t h32 = p2t_f64i32_holes_create_int32(1, (const int32_t[]){ 4 });
+    p2t_f64i32_triangles_t t32 = p2t_f64i32_polygon_earcut(v32, h32);
+    ASSERT(t32 != NULL);
+
+    ASSERT_EQ(8, p2t_f32i16_triangles_num(t16));
+    ASSERT_EQ(8, p2t_f64i32_triangles_num(t32));
+    for (int16_t t = 0; t < 8; ++t) {
+        const int16_t* a = p2t_f32i16_triangles_nth(t16, t);
+        const int32_t* b = p2t_f64i32_triangles_nth(t32, t);
+        ASSERT_EQ(a[0], b[0]);
+        ASSERT_EQ(a[1], b[1]);
+        ASSERT_EQ(a[2], b[2]);
+    }
+
+    p2t_f32i16_triangles_free(t16);
+    p2t_f32i16_holes_destory(h16);
+    p2t_f32i16_vertices_destroy(v16);
+    p2t_f64i32_triangles_free(t32);
+    p2t_f64i32_holes_destory(h32);
+    p2t_f64i32_vertices_destroy(v32);
+    PASS();
+}
+
+TEST triangulate_test(void) {
+    const float xf[] = { 0, 4, 4, 2, 0 };
+    const float yf[] = { 0, 0, 3, 5, 3 };
+    const double xd[] = { 0, 4, 4, 2, 0 };
+    const double yd[] = { 0, 0, 3, 5, 3 };
+
+    p2t_f32i16_vertices_t v16 = p2t_f32i16_vertices_attach(5, xf, yf);
+    p2t_f64i32_vertices_t v32 = p2t_f64i32_vertices_attach(5, xd, yd);
+    ASSERT_EQ(p2t_f32i16_signed_area(v16, 0, 5), (float)p2t_f64i32_signed_area(v32, 0, 5));
+
+    p2t_f32i16_triangles_t t16 = p2t_f32i16_polygon_triangulate(v16);
+    p2t_f64i32_triangles_t t32 = p2t_f64i32_polygon_triangulate(v32);
+    ASSERT(t16 != NULL && t32 != NULL);
+    ASSERT_EQ(3, p2t_f32i16_triangles_num(t16));
+    ASSERT_EQ(3, p2t_f64i32_triangles_num(t32));
+
+    p2t_f32i16_triangles_free(t16);
+    p2t_f64i32_triangles_free(t32);
+    p2t_f32i16_vertices_destroy(v16);
+    p2t_f64i32_vertices_destroy(v32);
+    PASS();
+}
+
+TEST pick_test(int32_t n, double cx, double cy, int expected_pick) {
+    double* x = malloc(n * sizeof(x[0]));
+    double* y = malloc(n * sizeof(y[0]));
+    star_ring(n, cx, cy, 100, x, y);
+    int picked = 0;
+    int32_t m = earcut_any(n, x, y, &picked);
+    free(x);
+    free(y);
+    ASSERT_EQ(expected_pick, picked);
+    ASSERT_EQ(n - 2, m);
+    PASS();
+}
+
+SUITE(instance_tests) {
+    RUN_TEST(same_result_test);
+    RUN_TEST(triangulate_test);
+    // a tile
+    RUN_TESTp(pick_test, 1000, 0, 0, 16);
+    // too many vertices for int16_t
+    RUN_TESTp(pick_test, 40000, 0, 0, 32);
+    // cadastral coordinates, too far out for float
+    RUN_TESTp(pick_test, 1000, 4.5e6, 5.5e6, 32);
+}
+
+GREATEST_MAIN_DEFS();
+
+int main(int argc, char* argv[]) {
+    GREATEST_MAIN_BEGIN();
+    RUN_SUITE(instance_tests);
+    GREATEST_MAIN_END();
+}
@@ -0,0 +1,8 @@
+// tile meshes: float coordinates, 16-bit indices
+
+#define POLY2TRI_PREFIX p2t_f32i16_
+#define USING_INT16_INDEX
+
+#define POLY2TRI_IMPLEMENTATION
+#include "polygon_earcut.h"
+#include "polygon_triangulate.h"
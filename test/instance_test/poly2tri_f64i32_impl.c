@@ -0,0 +1,8 @@
+// cadastral data: double coordinates, 32-bit indices
+
+#define POLY2TRI_PREFIX p2t_f64i32_
+#define USING_DOUBLE_COORD
+
+#define POLY2TRI_IMPLEMENTATION
+#include "polygon_earcut.h"
+#include "polygon_triangulate.h"
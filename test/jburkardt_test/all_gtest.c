@@ -11,6 +11,8 @@
 #include "polygon_triangulate.h"
 
 #include "test_utils.h"
+#include "polygon_generator.h"
+
 TEST only_one(void) {
     coord_t x[] = {8.0, 7.0, 6.0, 7.0};
     coord_t y[] = {1.0, 10.0, 0.0, -10.0};
@@ -18,10 +20,10 @@ TEST only_one(void) {
     vertices_t vertices = vertices_create(n, x, y);
     ASSERT_EQ(n, vertices_num(vertices));
 
-    //reverse_polygon(polygon);  // cannot do clockwise-polygon, DONOT do this
+    //reverse_polygon(polygon);  // clockwise works too, see clockwise_suite
     print_polygon(vertices);
     triangles_t triangles = polygon_triangulate(vertices);
-    ASSERTm("MUST BE counterclockwise-polygon", triangles != NULL);
+    ASSERT(triangles != NULL);
     __auto_type m = triangles_num(triangles);
     ASSERT_EQ(n - 2, m);
 
@@ -88,9 +90,357 @@ TEST common_one(void) {
     polygon_destroy(polygon);
     PASS();
 }
+TEST threads_one(const vidx_t n, int nthreads) {
+    vertices_t vertices = polygon_generate(n);
+    ASSERT_EQ(n, vertices_num(vertices));
+
+    triangles_t expected = polygon_triangulate(vertices);
+    ASSERT(NULL != expected);
+
+    triangles_t triangles = polygon_triangulate_ex(vertices, POLY2TRI_THREADS(nthreads), 0);
+    ASSERT(NULL != triangles);
+    ASSERT_EQ(n - 2, triangles_num(triangles));
+    ASSERT_MEM_EQ(triangles_nth(expected, 0), triangles_nth(triangles, 0), 3 * (n - 2) * sizeof(vidx_t));
+
+    polygon_t polygon = polygon_build(vertices, NULL);
+    ASSERT( diff_areas(polygon, triangles) < 0.00001);
+
+    triangles_free(expected);
+    triangles_free(triangles);
+    polygon_destroy(polygon);
+    PASS();
+}
+
+TEST workspace_one(const vidx_t n) {
+    vertices_t vertices = polygon_generate(n);
+    triangles_t expected = polygon_triangulate(vertices);
+    ASSERT(NULL != expected);
+
+    void* work = malloc(polygon_triangulate_workspace_size(n));
+    vidx_t* tris = calloc(3 * (n - 2), sizeof(vidx_t));
+    // the same workspace serves any number of calls
+    for (int k = 0; k < 3; ++k) {
+        ASSERT_EQ(n - 2, polygon_triangulate_work(vertices, 0, 0, work, tris));
+        ASSERT_MEM_EQ(triangles_nth(expected, 0), tris, 3 * (n - 2) * sizeof(vidx_t));
+    }
+
+    free(tris);
+    free(work);
+    triangles_free(expected);
+    vertices_destroy(vertices);
+    PASS();
+}
+
+TEST quantized_one(const vidx_t n) {
+    vertices_t vertices = polygon_generate(n);
+    coord_t* x = calloc(2 * n, sizeof(coord_t));
+    coord_t* y = x + n;
+    coord_t minx = REAL_MAX_VALUE(minx), maxx = -REAL_MAX_VALUE(maxx);
+    for (vidx_t i = 0; i < n; ++i) {
+        x[i] = vertices_nth_getx(vertices, i);
+        y[i] = vertices_nth_gety(vertices, i);
+        minx = THE_MIN(minx, x[i]);
+        maxx = THE_MAX(maxx, x[i]);
+    }
+    vertices_t quantized = vertices_quantize(n, x, y);
+    ASSERT_EQ(n, vertices_num(quantized));
+    // within half a step of the x extent, which is at most the longer side
+    const double tol = (maxx - minx) / 65535.0;
+    for (vidx_t i = 0; i < n; ++i) {
+        ASSERT_IN_RANGE(x[i], vertices_nth_getx(quantized, i), tol);
+        ASSERT_IN_RANGE(y[i], vertices_nth_gety(quantized, i), 2 * tol);
+    }
+
+    triangles_t triangles = polygon_triangulate(quantized);
+    ASSERT(NULL != triangles);
+    ASSERT_EQ(n - 2, triangles_num(triangles));
+    polygon_t polygon = polygon_build(quantized, NULL);
+    ASSERT( diff_areas(polygon, triangles) < 0.00001);
+
+    triangles_free(triangles);
+    polygon_destroy(polygon);
+    vertices_destroy(vertices);
+    free(x);
+    PASS();
+}
+
+TEST strided_one(const vidx_t n) {
+    vertices_t vertices = polygon_generate(n);
+    // [x0, y0, x1, y1, ...]
+    coord_t* xy = calloc(2 * n, sizeof(coord_t));
+    for (vidx_t i = 0; i < n; ++i) {
+        xy[2 * i] = vertices_nth_getx(vertices, i);
+        xy[2 * i + 1] = vertices_nth_gety(vertices, i);
+    }
+    vertices_t strided = vertices_attach_strided(n, xy, 2 * sizeof(coord_t), 0, sizeof(coord_t));
+
+    triangles_t expected = polygon_triangulate(vertices);
+    ASSERT(NULL != expected);
+    triangles_t triangles = polygon_triangulate(strided);
+    ASSERT(NULL != triangles);
+    ASSERT_EQ(n - 2, triangles_num(triangles));
+    ASSERT_MEM_EQ(triangles_nth(expected, 0), triangles_nth(triangles, 0), 3 * (n - 2) * sizeof(vidx_t));
+
+    triangles_free(expected);
+    triangles_free(triangles);
+    vertices_destroy(strided);
+    vertices_destroy(vertices);
+    free(xy);
+    PASS();
+}
+
+TEST simd_levels_one(const vidx_t n) {
+    vertices_t vertices = polygon_generate(n);
+    const int best = geometry_simd_set_level(GEOMETRY_SIMD_AVX512);
+
+    ASSERT_EQ(GEOMETRY_SIMD_BASELINE, geometry_simd_set_level(GEOMETRY_SIMD_BASELINE));
+    triangles_t expected = polygon_triangulate(vertices);
+    ASSERT(NULL != expected);
+    // diagonalie() runs through intersects_any() at every level
+    for (int level = GEOMETRY_SIMD_BASELINE + 1; level <= best; ++level) {
+        ASSERT_EQ(level, geometry_simd_set_level(level));
+        triangles_t triangles = polygon_triangulate(vertices);
+        ASSERT(NULL != triangles);
+        ASSERT_MEM_EQ(triangles_nth(expected, 0), triangles_nth(triangles, 0), 3 * (n - 2) * sizeof(vidx_t));
+        triangles_free(triangles);
+    }
+    geometry_simd_set_level(GEOMETRY_SIMD_AUTO);
+
+    triangles_free(expected);
+    vertices_destroy(vertices);
+    PASS();
+}
+
+TEST attach_one(const vidx_t n) {
+    vertices_t vertices = polygon_generate(n);
+    triangles_t expected = polygon_triangulate(vertices);
+    ASSERT(NULL != expected);
+
+    // two polygons back to back in one buffer, the second one a triangle short
+    vidx_t* buffer = malloc(3 * (2 * n - 5) * sizeof(vidx_t));
+    triangles_t triangles = triangles_attach(2 * n - 5, buffer);
+    ASSERT(polygon_triangulate_to(vertices, 0, 0, triangles));
+    ASSERT_EQ(n - 2, triangles_num(triangles));
+    ASSERT_EQ(buffer, triangles_nth(triangles, 0));
+    ASSERT_MEM_EQ(triangles_nth(expected, 0), buffer, 3 * (n - 2) * sizeof(vidx_t));
+
+    ASSERT_FALSE(polygon_triangulate_to(vertices, 0, 0, triangles));
+    ASSERT_EQ(n - 2, triangles_num(triangles));
+
+    triangles_free(triangles);
+    triangles_free(expected);
+    free(buffer);
+    vertices_destroy(vertices);
+    PASS();
+}
+
+struct collected {
+    vidx_t num;
+    vidx_t flushes;
+    vidx_t* tri;
+};
+
+static void collect(void* ctx, vidx_t first, vidx_t num, const vidx_t tri[]) {
+    struct collected* c = ctx;
+    // in order, without gaps
+    if (first == c->num) {
+        memcpy(c->tri + 3 * first, tri, 3 * num * sizeof(vidx_t));
+        c->num += num;
+    }
+    c->flushes++;
+}
+
+TEST stream_one(const vidx_t n) {
+    vertices_t vertices = polygon_generate(n);
+    triangles_t expected = polygon_triangulate(vertices);
+    ASSERT(NULL != expected);
+
+    struct collected c = { .tri = malloc(3 * (n - 2) * sizeof(vidx_t)) };
+    triangles_t stream = triangles_stream(TRIANGLES_STREAM_BATCH, collect, &c);
+    ASSERT(polygon_triangulate_to(vertices, 0, 0, stream));
+    ASSERT_EQ(n - 2, triangles_num(stream));
+    ASSERT_EQ(n - 2, c.num);
+    ASSERT_EQ((n - 2 + TRIANGLES_STREAM_BATCH - 1) / TRIANGLES_STREAM_BATCH, c.flushes);
+    ASSERT_MEM_EQ(triangles_nth(expected, 0), c.tri, 3 * (n - 2) * sizeof(vidx_t));
+
+    triangles_free(stream);
+    triangles_free(expected);
+    free(c.tri);
+    vertices_destroy(vertices);
+    PASS();
+}
+
+TEST adjacency_one(const vidx_t n) {
+    vertices_t vertices = polygon_generate(n);
+    triangles_t expected = polygon_triangulate(vertices);
+    ASSERT(NULL != expected);
+    triangles_t triangles = polygon_triangulate_ex(vertices, POLY2TRI_ADJACENCY, 0);
+    ASSERT(NULL != triangles);
+    ASSERT_MEM_EQ(triangles_nth(expected, 0), triangles_nth(triangles, 0), 3 * (n - 2) * sizeof(vidx_t));
+    // every polygon edge once on the boundary, every diagonal shared
+    ASSERT_EQ(n, adjacency_boundary(triangles));
+
+    triangles_free(triangles);
+    triangles_free(expected);
+    vertices_destroy(vertices);
+    PASS();
+}
+
+TEST strip_one(const vidx_t n) {
+    vertices_t vertices = polygon_generate(n);
+    triangles_t triangles = polygon_triangulate_ex(vertices, POLY2TRI_ADJACENCY, 0);
+    ASSERT(NULL != triangles);
+    const size_t max = triangles_strip(triangles, 0, NULL);
+    ASSERT(max <= TRIANGLES_STRIP_MAX(n - 2));
+    vidx_t* strip = malloc(max * sizeof(vidx_t));
+    ASSERT_EQ(max, triangles_strip(triangles, max, strip));
+    ASSERT(strip_matches(triangles, max, strip));
+    // well under the 3 indices of a triangle list
+    ASSERT(max < 3 * (size_t)(n - 2));
+
+    free(strip);
+    triangles_free(triangles);
+    vertices_destroy(vertices);
+    PASS();
+}
+
+SUITE(generated_suite) {
+    RUN_TESTp(threads_one, 1000, 2);
+    RUN_TESTp(threads_one, 1000, 4);
+    RUN_TESTp(threads_one, 1000, 64);
+    // more than POLY2TRI_THREADS_MAX, clamped
+    RUN_TESTp(threads_one, 1000, 1000);
+    RUN_TESTp(workspace_one, 300);
+    RUN_TESTp(quantized_one, 1000);
+    RUN_TESTp(strided_one, 1000);
+    RUN_TESTp(simd_levels_one, 1000);
+    RUN_TESTp(attach_one, 1000);
+    RUN_TESTp(stream_one, 1000);
+    RUN_TESTp(adjacency_one, 1000);
+    RUN_TESTp(strip_one, 1000);
+}
+
+TEST trusted_one(void) {
+    coord_t x[] = {70.0, 60.0, 0.0, 10.0};
+    coord_t y[] = {10.0, 60.0, 50.0, 0.0};
+    const int n = ARR_LEN(x);
+    vertices_t vertices = vertices_create(n, x, y);
+
+    triangles_t expected = polygon_triangulate(vertices);
+    ASSERT(NULL != expected);
+
+    triangles_t triangles = polygon_triangulate_ex(vertices, POLY2TRI_TRUSTED, 0);
+    ASSERT(NULL != triangles);
+    ASSERT_EQ(n - 2, triangles_num(triangles));
+    ASSERT_MEM_EQ(triangles_nth(expected, 0), triangles_nth(triangles, 0), 3 * (n - 2) * sizeof(vidx_t));
+    triangles_free(triangles);
+
+    // a precomputed area replaces the one of the validation pass
+    triangles = polygon_triangulate_ex(vertices, 0, signed_area(vertices, 0, n));
+    ASSERT(NULL != triangles);
+    ASSERT_MEM_EQ(triangles_nth(expected, 0), triangles_nth(triangles, 0), 3 * (n - 2) * sizeof(vidx_t));
+    triangles_free(triangles);
+    // and isn't summed again: only its sign counts
+    triangles = polygon_triangulate_ex(vertices, 0, 1);
+    ASSERT(NULL != triangles);
+    ASSERT_MEM_EQ(triangles_nth(expected, 0), triangles_nth(triangles, 0), 3 * (n - 2) * sizeof(vidx_t));
+    triangles_free(triangles);
+
+    // a wrong orientation is caught by the cutting loop instead of spinning forever
+    ASSERT_EQ(NULL, polygon_triangulate_ex(vertices, POLY2TRI_TRUSTED, -1));
+
+    triangles_free(expected);
+    vertices_destroy(vertices);
+    PASS();
+}
+
+TEST clockwise_one(const int n, const coord_t x[n], const coord_t y[n]) {
+    vertices_t vertices = vertices_create(n, x, y);
+    triangles_t expected = polygon_triangulate(vertices);
+    ASSERT(NULL != expected);
+
+    // the same ring clockwise: triangulated through the reversed view, mapped back by i -> n-1-i
+    vertices_t reversed = vertices_create(n, x, y);
+    reverse_polygon(reversed);
+    ASSERT(signed_area(reversed, 0, n) < 0);
+    triangles_t triangles = polygon_triangulate(reversed);
+    ASSERT(NULL != triangles);
+    ASSERT_EQ(n - 2, triangles_num(triangles));
+    for (vidx_t i = 0; i < n - 2; ++i) {
+        vidx_t* tri = triangles_nth(triangles, i);
+        vidx_t* etri = triangles_nth(expected, i);
+        for (int k = 0; k < 3; ++k) ASSERT_EQ(etri[k], n - 1 - tri[k]);
+        // still counter-clockwise
+        ASSERT(triangle_area(vertices_nth_getx(reversed, tri[0]), vertices_nth_gety(reversed, tri[0]),
+                             vertices_nth_getx(reversed, tri[1]), vertices_nth_gety(reversed, tri[1]),
+                             vertices_nth_getx(reversed, tri[2]), vertices_nth_gety(reversed, tri[2])) > 0);
+    }
+    triangles_free(triangles);
+
+    triangles = polygon_triangulate_ex(reversed, POLY2TRI_TRUSTED, -1);
+    ASSERT(NULL != triangles);
+    ASSERT_EQ(n - 2, triangles_num(triangles));
+    polygon_t polygon = polygon_build(reversed, NULL);
+    ASSERT( diff_areas(polygon, triangles) < 0.00001);
+
+    triangles_free(triangles);
+    triangles_free(expected);
+    polygon_destroy(polygon);
+    vertices_destroy(vertices);
+    PASS();
+}
+
+TEST intersects_any_one(void) {
+    // small integers make plenty of collinear and touching segments
+    enum { M = 203 };
+    coord_t xc[M], yc[M], xd[M], yd[M];
+    srand(26);
+    for (int round = 0; round < 200; ++round) {
+        coord_t ax = rand() % 8, ay = rand() % 8, bx = rand() % 8, by = rand() % 8;
+        for (int k = 0; k < M; ++k) {
+            xc[k] = rand() % 8; yc[k] = rand() % 8;
+            xd[k] = rand() % 8; yd[k] = rand() % 8;
+        }
+        for (int k = 0; k < M; ++k) {
+            bool expected = intersects(ax, ay, bx, by, xc[k], yc[k], xd[k], yd[k]);
+            ASSERT_EQ(expected, intersects_any(ax, ay, bx, by, 1, xc + k, yc + k, xd + k, yd + k));
+        }
+        // one lane at a time against the whole vector
+        for (int k = 0; k + 16 <= M; k += 16) {
+            bool expected = false;
+            for (int l = k; l < k + 16; ++l) expected |= intersects(ax, ay, bx, by, xc[l], yc[l], xd[l], yd[l]);
+            ASSERT_EQ(expected, intersects_any(ax, ay, bx, by, 16, xc + k, yc + k, xd + k, yd + k));
+        }
+    }
+    PASS();
+}
+
+SUITE(clockwise_suite) {
+    {
+        coord_t x[] = {70.0, 60.0, 0.0, 10.0};
+        coord_t y[] = {10.0, 60.0, 50.0, 0.0};
+        RUN_TESTp(clockwise_one, ARR_LEN(x), x, y);
+    }
+    {
+#ifdef USING_INT32_COORD
+#include "hand_i32_data.h"
+#else
+#include "hand_data.h"
+#endif
+        RUN_TESTp(clockwise_one, ARR_LEN(x), x, y);
+    }
+    {
+#include "comb_data.h"
+        (void)expected_triangles;
+        RUN_TESTp(clockwise_one, ARR_LEN(x), x, y);
+    }
+}
+
 SUITE(simple_suite) {
     RUN_TEST(only_one);
     RUN_TEST(illegal_one);
+    RUN_TEST(trusted_one);
+    RUN_TEST(intersects_any_one);
 
     RUN_TEST(common_one);
 }
@@ -103,6 +453,8 @@ int main(int argc, char* argv[]) {
     GREATEST_MAIN_BEGIN();
 
     RUN_SUITE(simple_suite);
+    RUN_SUITE(generated_suite);
+    RUN_SUITE(clockwise_suite);
 
     RUN_SUITE(the_i18_suite);
     RUN_SUITE(the_comb_suite);
@@ -66,7 +66,12 @@ vidx_t expected_triangles[][3] = {
 };
 
 TEST hand_test(void) {
+#ifdef USING_INT32_COORD
+    // the fractional coordinates would truncate to 0, the same hand scaled by 10^4
+    #include "hand_i32_data.h"
+#else
     #include "hand_data.h"
+#endif
     const int n = ARR_LEN(x);
     ASSERT_EQ(n, ARR_LEN(y));
     vertices_t vertices = vertices_create(n, x, y);
@@ -2,6 +2,9 @@
 #define STBIDEF static inline
 #endif                       
 
+#define POLYGON_GENERATOR_IMPLEMENTAION
+#include "polygon_generator.h"
+
 #define TEST_UTILS_IMPLEMENTATION
 #include "test_utils.h"
 